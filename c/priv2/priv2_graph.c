@@ -49,6 +49,10 @@
 #define TRUE_OR_EINVAL(cond) if (!cond) { errno = EINVAL; return -1; }
 #define TRUE_OR_EPERM(cond) if (!cond) { errno = EPERM; return -1; }
 #define ZERO_OR_RTN_ERROR(num) if (num != 0) { return -1; }
+// Whether the state at index to can be reached from the state at index from
+#define STATE_IS_REACHABLE(from, to)                                    \
+    ((reachability_matrix[from][(to) / REACHABILITY_WORD_BITS] >>       \
+      ((to) % REACHABILITY_WORD_BITS)) & 1u)
 
 
 //##############################################################################
@@ -84,14 +88,6 @@ static bool can_set_suid_for_identity_change(
 CAN_SET_IDS_FROM_GRAPH_DECL(uids);
 CAN_SET_IDS_FROM_GRAPH_DECL(gids);
 
-#define CAN_SET_IDS_FROM_GRAPH_RECURSIVE_DECL(id_name)          \
-    static bool can_set_ ## id_name ## _from_graph_recursive(   \
-        uid_t const* predecessor_list,                          \
-        int const first_idx,                                    \
-        int const next_idx)
-CAN_SET_IDS_FROM_GRAPH_RECURSIVE_DECL(uids);
-CAN_SET_IDS_FROM_GRAPH_RECURSIVE_DECL(gids);
-
 #define SET_IDS_FROM_GRAPH_RECURSIVE_DECL(id_name)              \
     static int set_ ## id_name ## _from_graph_recursive(        \
         norm_pcred_pair_t const* p,                             \
@@ -250,11 +246,7 @@ uids_t const get_suid_for_identity_change(norm_pcred_pair_t const* p) {
         if (first_idx < 0 || second_idx < 0) {                          \
             rtn = false;                                                \
         } else {                                                        \
-            uid_t const* predecessor_list = predecessor_matrix[first_idx]; \
-            rtn = can_set_ ## id_name ## _from_graph_recursive(         \
-                predecessor_list,                                       \
-                first_idx,                                              \
-                second_idx);                                            \
+            rtn = STATE_IS_REACHABLE(first_idx, second_idx);            \
         }                                                               \
         DPN(3, "Can set " #id_name " return %d; normalized values: <%d, %d, %d> to <%d, %d, %d>", \
             rtn,                                                        \
@@ -280,29 +272,6 @@ uids_t const get_suid_for_identity_change(norm_pcred_pair_t const* p) {
 CAN_SET_IDS_FROM_GRAPH_DEFN(uids);
 CAN_SET_IDS_FROM_GRAPH_DEFN(gids);
 
-#define CAN_SET_IDS_FROM_GRAPH_RECURSIVE_DEFN(id_name)          \
-    static bool can_set_ ## id_name ## _from_graph_recursive(   \
-        uid_t const* predecessor_list,                          \
-        int const first_idx,                                    \
-        int const next_idx) {                                   \
-        if(next_idx < 0) {                                      \
-            return false;                                       \
-        }                                                       \
-        if (next_idx == first_idx) {                            \
-            return true;                                        \
-        }                                                       \
-        int const prev_idx = predecessor_list[next_idx];        \
-        if (prev_idx == next_idx) {                             \
-            return false;                                       \
-        }                                                       \
-        return can_set_ ## id_name ## _from_graph_recursive(    \
-            predecessor_list,                                   \
-            first_idx,                                          \
-            prev_idx);                                          \
-    }
-CAN_SET_IDS_FROM_GRAPH_RECURSIVE_DEFN(uids);
-CAN_SET_IDS_FROM_GRAPH_RECURSIVE_DEFN(gids);
-
 #define SET_IDS_FROM_GRAPH_DEFN(id_name)                                \
     int set_ ## id_name ## _from_graph(                                 \
         norm_pcred_pair_t const* p) {                                   \
@@ -38,6 +38,9 @@ public:
         VertexProperty const& s2) const = 0;
 };
 
+// Functors are evaluated directly on each edge. Compiling them into truth
+// tables keyed by which of an edge's UIDs are equal was measured and was
+// slower: computing an edge's pattern costs more than the inlined checks
 #define APF_CLASSNAME(_name) \
     template<typename Graph>  \
     class _name : public APFunctor< Graph >
@@ -107,15 +110,15 @@ private:
 
 APF_START(SetuidSuccessAP) {
     return (fc.rtn.value == 0 &&
-            s2.ruid == P2U(fc.params.at(0)) &&
-            s2.euid == P2U(fc.params.at(0)) &&
-            s2.svuid == P2U(fc.params.at(0)));
+            s2.ruid == P2U(fc.params().at(0)) &&
+            s2.euid == P2U(fc.params().at(0)) &&
+            s2.svuid == P2U(fc.params().at(0)));
 } APF_FINISH
 
 APF_START(SetuidSuccessNAP) {
     return (fc.rtn.value == 0 &&
             s2.ruid == s1.ruid &&
-            s2.euid == P2U(fc.params.at(0)) &&
+            s2.euid == P2U(fc.params().at(0)) &&
             s2.svuid == s1.svuid);
 } APF_FINISH
 
@@ -134,8 +137,8 @@ private:
 };
 
 APF_START(SetuidNAPUIDIsValid) {
-    return (s1.ruid == P2U(fc.params.at(0)) ||
-            s1.svuid == P2U(fc.params.at(0)));
+    return (s1.ruid == P2U(fc.params().at(0)) ||
+            s1.svuid == P2U(fc.params().at(0)));
 } APF_FINISH
 
 APF_CLASSNAME(SetuidImpliesAP) {
@@ -222,7 +225,7 @@ private:
 APF_START(SeteuidSuccess) {
     return (fc.rtn.value == 0 &&
             s2.ruid == s1.ruid &&
-            s2.euid == P2U(fc.params.at(0)) &&
+            s2.euid == P2U(fc.params().at(0)) &&
             s2.svuid == s1.svuid);
 } APF_FINISH
 
@@ -344,23 +347,23 @@ private:
 // (9) Try: Interpret unqualified "real user ID" as param_ruid value
 
 APF_START(SetreuidRuidSuccess) {
-    return ((fc.params.at(0) == -1 && s2.ruid == s1.ruid) ||
-            (fc.params.at(0) != -1 && s2.ruid == P2U(fc.params.at(0))));
+    return ((fc.params().at(0) == -1 && s2.ruid == s1.ruid) ||
+            (fc.params().at(0) != -1 && s2.ruid == P2U(fc.params().at(0))));
 } APF_FINISH
 
 APF_START(SetreuidEuidSuccess) {
-    return ((fc.params.at(1) == -1 && s2.euid == s1.euid) ||
-            (fc.params.at(1) != -1 && s2.euid == P2U(fc.params.at(1))));
+    return ((fc.params().at(1) == -1 && s2.euid == s1.euid) ||
+            (fc.params().at(1) != -1 && s2.euid == P2U(fc.params().at(1))));
 } APF_FINISH
 
 APF_START(SetreuidSetSvuid) {
     return (// fc.params.at(1) != -1 && // REMOVED: Number (6) above
             // Cleaned up standard specification (contains redundant
             // "fc.params.at(1) != -1")
-            (fc.params.at(0) != -1 ||
-             (fc.params.at(1) != -1 &&
+            (fc.params().at(0) != -1 ||
+             (fc.params().at(1) != -1 &&
               // Without (9) above:
-              P2U(fc.params.at(1)) != s1.ruid
+              P2U(fc.params().at(1)) != s1.ruid
               // With (9) above:
               // fc.params.at(1) != fc.params.at(0)
                  )));
@@ -401,16 +404,16 @@ private:
 // This is currently dead code, because...
 // REMOVED: Number (8) above
 APF_START(SetreuidParamRuidIsValid) {
-    return (fc.params.at(0) == -1 ||
-            P2U(fc.params.at(0)) == s1.ruid ||
-            P2U(fc.params.at(0)) == s1.euid);
+    return (fc.params().at(0) == -1 ||
+            P2U(fc.params().at(0)) == s1.ruid ||
+            P2U(fc.params().at(0)) == s1.euid);
 } APF_FINISH
 
 APF_START(SetreuidParamEuidIsValid) {
-    return (fc.params.at(1) == -1 ||
-            P2U(fc.params.at(1)) == s1.ruid ||
-            P2U(fc.params.at(1)) == s1.euid ||
-            P2U(fc.params.at(1)) == s1.svuid); // Number (4a) above
+    return (fc.params().at(1) == -1 ||
+            P2U(fc.params().at(1)) == s1.ruid ||
+            P2U(fc.params().at(1)) == s1.euid ||
+            P2U(fc.params().at(1)) == s1.svuid); // Number (4a) above
 } APF_FINISH
 
 // Commented out code below:
@@ -599,16 +602,16 @@ private:
 // This is currently dead code, because...
 // REMOVED: Number (8) above
 APF_START(SetreuidCleanParamRuidIsValid) {
-    return (fc.params.at(0) == -1 ||
-            P2U(fc.params.at(0)) == s1.ruid ||
-            P2U(fc.params.at(0)) == s1.euid);
+    return (fc.params().at(0) == -1 ||
+            P2U(fc.params().at(0)) == s1.ruid ||
+            P2U(fc.params().at(0)) == s1.euid);
 } APF_FINISH
 
 APF_START(SetreuidCleanParamEuidIsValid) {
-    return (fc.params.at(1) == -1 ||
-            P2U(fc.params.at(1)) == s1.ruid ||
-            P2U(fc.params.at(1)) == s1.euid ||
-            P2U(fc.params.at(1)) == s1.svuid); // Number (4a) above
+    return (fc.params().at(1) == -1 ||
+            P2U(fc.params().at(1)) == s1.ruid ||
+            P2U(fc.params().at(1)) == s1.euid ||
+            P2U(fc.params().at(1)) == s1.svuid); // Number (4a) above
 } APF_FINISH
 
 APF_CLASSNAME(SetreuidCleanImpliesAP) {
@@ -727,17 +730,17 @@ private:
 // Setresuid
 
 APF_START(SetresuidParamRuidIsValid) {
-    UID const& p = P2U(fc.params.at(0));
+    UID const& p = P2U(fc.params().at(0));
     return (p == P2U(-1) || p == s1.ruid || p == s1.euid || p == s1.svuid);
 } APF_FINISH
 
 APF_START(SetresuidParamEuidIsValid) {
-    UID const& p = P2U(fc.params.at(1));
+    UID const& p = P2U(fc.params().at(1));
     return (p == P2U(-1) || p == s1.ruid || p == s1.euid || p == s1.svuid);
 } APF_FINISH
 
 APF_START(SetresuidParamSvuidIsValid) {
-    UID const& p = P2U(fc.params.at(2));
+    UID const& p = P2U(fc.params().at(2));
     return (p == P2U(-1) || p == s1.ruid || p == s1.euid || p == s1.svuid);
 } APF_FINISH
 
@@ -762,8 +765,8 @@ private:
 #define SetresuidEuidSuccess SetreuidEuidSuccess
 
 APF_START(SetresuidSvuidSuccess) {
-    return ((fc.params.at(2) == -1 && s2.svuid == s1.svuid) ||
-            (fc.params.at(2) != -1 && s2.svuid == P2U(fc.params.at(2))));
+    return ((fc.params().at(2) == -1 && s2.svuid == s1.svuid) ||
+            (fc.params().at(2) != -1 && s2.svuid == P2U(fc.params().at(2))));
 } APF_FINISH
 
 APF_CLASSNAME(SetresuidSuccess) {
@@ -808,13 +811,14 @@ private:
 APF_CLASSNAME(SetreuidForDropPrivPerm) {
     APF_HEADER(SetreuidForDropPrivPerm);
     APF_OP {
-        if (fc.params.at(0) != fc.params.at(1)) {
+        if (fc.params().at(0) != fc.params().at(1)) {
             return true;
         }
         // else (params are the same):
-        SetuidFunctionCall setresuidFn(fc);
-        setresuidFn.function = Setresuid;
-        setresuidFn.params.push_back(fc.params.at(0));
+        SetuidFunctionParams setresuidParams(fc.params());
+        setresuidParams.push_back(fc.params().at(0));
+        SetuidFunctionCall const setresuidFn(
+            Setresuid, setresuidParams, fc.rtn);
         return (V(setreuidSuccess) == setresuidSuccess(setresuidFn, s1, s2));
     }
 public:
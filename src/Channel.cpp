@@ -0,0 +1,88 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "Channel.h"
+
+#include "Assertions.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <vector>
+
+typedef uint32_t FrameLength;
+
+static bool writeAll(FileDescriptor fd, char const* buffer, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, buffer, size);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        buffer += written;
+        size -= written;
+    }
+    return true;
+}
+
+static bool readAll(FileDescriptor fd, char* buffer, size_t size) {
+    while (size > 0) {
+        ssize_t numRead = read(fd, buffer, size);
+        if (numRead == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        } else if (numRead == 0) {
+            return false;
+        }
+        buffer += numRead;
+        size -= numRead;
+    }
+    return true;
+}
+
+unsigned maxAtomicFramePayload() {
+    return PIPE_BUF - sizeof(FrameLength);
+}
+
+bool writeFrame(FileDescriptor fd, std::string const& payload) {
+    FrameLength const length = payload.size();
+    std::vector<char> frame(sizeof(length) + payload.size());
+    std::memcpy(&frame[0], &length, sizeof(length));
+    if (payload.size() > 0) {
+        std::memcpy(&frame[sizeof(length)], payload.data(), payload.size());
+    }
+    return writeAll(fd, &frame[0], frame.size());
+}
+
+bool readFrame(FileDescriptor fd, std::string& payload) {
+    FrameLength length;
+    if (!readAll(fd, reinterpret_cast<char*>(&length), sizeof(length))) {
+        return false;
+    }
+    std::vector<char> buffer(length);
+    if (length > 0 && !readAll(fd, &buffer[0], length)) {
+        return false;
+    }
+    payload.assign(buffer.begin(), buffer.end());
+    return true;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "WireFormat.h"
+
+#include <sys/types.h>
+
+#include <sstream>
+#include <string>
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+
+typedef int FileDescriptor;
+
+// Length-prefixed frames over pipes. A frame no larger than PIPE_BUF is
+// written with a single write(), so several processes may share one pipe
+// for sending frames to a single reader.
+
+bool writeFrame(FileDescriptor fd, std::string const& payload);
+
+// Returns false on end-of-file (or error) before a complete frame arrives
+bool readFrame(FileDescriptor fd, std::string& payload);
+
+// Largest payload that can be sent atomically on a shared pipe
+unsigned maxAtomicFramePayload();
+
+// Values sent over pipes use the binary wire format, or boost text
+// archives when built with FORK_TEXT_ARCHIVE (to debug the exchange).
+// archiveFromString() returns false if str does not decode, as when a
+// child died while writing it
+
+template<typename T>
+std::string archiveToString(T const& t) {
+
+#if FORK_TEXT_ARCHIVE
+
+    std::ostringstream oss;
+    {
+        boost::archive::text_oarchive oa(oss);
+        oa << t;
+    }
+    return oss.str();
+
+#else
+
+    return wireEncode(t);
+
+#endif
+
+}
+
+template<typename T>
+bool archiveFromString(std::string const& str, T& t) {
+
+#if FORK_TEXT_ARCHIVE
+
+    try {
+        std::istringstream iss(str);
+        boost::archive::text_iarchive ia(iss);
+        ia >> t;
+    } catch (boost::archive::archive_exception const&) {
+        return false;
+    }
+    return true;
+
+#else
+
+    return wireDecode(str, t);
+
+#endif
+
+}
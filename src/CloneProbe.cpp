@@ -0,0 +1,148 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "CloneProbe.h"
+
+#include "Assertions.h"
+#include "Fork.h"
+#include "Platform.h"
+
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#if IS_LINUX
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+ProbeCall::ProbeCall(
+    SetuidFunction _function,
+    SetuidFunctionParams const& _params) :
+    function(_function),
+    numParams(_params.size()) {
+    ASSERT(numParams <= 3);
+    for (unsigned i = 0; i < numParams; ++i) {
+        params[i] = _params.at(i);
+    }
+}
+
+bool canCloneProbe(SetuidFunction function) {
+    if (!IS_LINUX) {
+        return false;
+    }
+    switch (function) {
+    default:
+        return false;
+    case Setuid:
+    case Seteuid:
+    case Setreuid:
+        return true;
+    case Setresuid:
+        return HAS_SETRESUID;
+    }
+}
+
+#if IS_LINUX
+
+namespace {
+
+struct ProbeTask {
+    ProbeCall const* calls;
+    unsigned numCalls;
+    ProbeResult* result;
+};
+
+// The caller is suspended until the probe exits, so one stack will do
+size_t const probeStackSize = 64 * 1024;
+char probeStack[probeStackSize] __attribute__((aligned(16)));
+
+long makeCall(ProbeCall const& call) {
+    UID const unchanged = 0 - 1;
+    switch (call.function) {
+    default:
+        errno = ENOSYS;
+        return -1;
+    case Setuid:
+        return syscall(SYS_setuid, call.params[0]);
+    case Seteuid:
+        // As glibc does it
+        if (static_cast<UID>(call.params[0]) == unchanged) {
+            errno = EINVAL;
+            return -1;
+        }
+        return syscall(SYS_setresuid, unchanged, call.params[0], unchanged);
+    case Setreuid:
+        return syscall(SYS_setreuid, call.params[0], call.params[1]);
+    case Setresuid:
+        return syscall(SYS_setresuid, call.params[0], call.params[1],
+                       call.params[2]);
+    }
+}
+
+// Runs in the probe: no allocation, no locks, nothing but system calls
+int probeEntry(void* arg) {
+    ProbeTask const* const task = static_cast<ProbeTask const*>(arg);
+    ProbeResult* const result = task->result;
+    for (unsigned i = 0; i < task->numCalls; ++i) {
+        result->value = makeCall(task->calls[i]);
+        result->errNumber = result->value == 0 ? 0 : errno;
+    }
+    UID ruid, euid, svuid;
+    if (syscall(SYS_getresuid, &ruid, &euid, &svuid) != 0) {
+        return 1;
+    }
+    result->state = SetuidState(ruid, euid, svuid);
+    return 0;
+}
+
+}
+
+bool cloneProbe(ProbeCall const* calls, unsigned numCalls, ProbeResult& result) {
+    ProbeTask task;
+    task.calls = calls;
+    task.numCalls = numCalls;
+    task.result = &result;
+
+    // The probe writes errno, which it shares with the caller
+    int const savedErrno = errno;
+    pid_t const pid = clone(
+        probeEntry,
+        probeStack + probeStackSize,
+        CLONE_VM | CLONE_VFORK | SIGCHLD,
+        &task);
+    if (pid == -1) {
+        return false;
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {}
+    __sync_fetch_and_add(&forkCounters().reaped, 1);
+    errno = savedErrno;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+#else
+
+bool cloneProbe(ProbeCall const* calls, unsigned numCalls, ProbeResult& result) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,52 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "SetuidState.h"
+
+// Probes for setuid-family calls that do not fork. A probe is a clone()d
+// task that shares the caller's memory (and runs on a small stack of its
+// own) while the caller is suspended, so starting one costs the same no
+// matter how much memory the caller holds. Credentials are per task, so the
+// calls change only the probe's. Probes make raw system calls and write
+// their result straight into the caller's memory.
+//
+// Only available on Linux; elsewhere cloneProbe() always fails.
+
+struct ProbeCall {
+    ProbeCall() : function(SetuidInvalid), numParams(0) {}
+    ProbeCall(SetuidFunction _function, SetuidFunctionParams const& _params);
+
+    SetuidFunction function;
+    unsigned numParams;
+    SetuidFunctionParam params[3];
+};
+
+struct ProbeResult {
+    // Of the last call made
+    int value;
+    int errNumber;
+    // Where the calls left the probe
+    SetuidState state;
+};
+
+// Whether a probe can make calls to function
+bool canCloneProbe(SetuidFunction function);
+
+// Make calls, in order, in a probe. Returns false if the probe could not be
+// started or did not finish
+bool cloneProbe(ProbeCall const* calls, unsigned numCalls, ProbeResult& result);
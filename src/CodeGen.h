@@ -514,6 +514,32 @@ private:
     }
 };
 
+class ReachabilityMatrixGenerator :
+    public ArrayConstGenerator< InlineArrayConstGenerator<unsigned> > {
+public:
+    typedef InlineArrayConstGenerator<unsigned> Item;
+    typedef std::vector<Item> ItemList;
+
+    ReachabilityMatrixGenerator(
+        NameGenerator& ng,
+        TypeGenerator<Item> const& _tg,
+        ItemList const& _items) :
+        ArrayConstGenerator< InlineArrayConstGenerator<unsigned> >(
+            ng,
+            generateNameParts(),
+            _tg,
+            _items) {}
+    virtual ~ReachabilityMatrixGenerator() {}
+
+private:
+    NameList generateNameParts() {
+        NameList l;
+        l.push_back("reachability");
+        l.push_back("matrix");
+        return l;
+    }
+};
+
 class PrivJumpsGenerator :
     public ArrayConstGenerator<SymbolGenerator> {
 public:
@@ -672,12 +698,12 @@ private:
     static ItemList generateItems(SetuidFunctionCall const& call) {
         static std::string const param = "param";
         ItemList l;
-        l.push_back(std::make_pair("function", call.function));
+        l.push_back(std::make_pair("function", call.function()));
         l.push_back(std::make_pair("rtn", call.rtn.value));
         l.push_back(std::make_pair("err", call.rtn.errNumber));
         unsigned count = 0;
-        for (SetuidFunctionParams::const_iterator it = call.params.begin(),
-                 ie = call.params.end(); it != ie; ++it) {
+        for (SetuidFunctionParams::const_iterator it = call.params().begin(),
+                 ie = call.params().end(); it != ie; ++it) {
             std::stringstream ss;
             ss << param;
             ss << static_cast<unsigned>(count);
@@ -723,14 +749,14 @@ private:
         NameList l;
         std::stringstream fn, rtn, err;
         l.push_back("call");
-        fn << static_cast<unsigned>(call.function);
+        fn << static_cast<unsigned>(call.function());
         l.push_back(fn.str());
         rtn << static_cast<unsigned>(call.rtn.value);
         l.push_back(rtn.str());
         err << static_cast<unsigned>(call.rtn.errNumber);
         l.push_back(err.str());
-        for (SetuidFunctionParams::const_iterator it = call.params.begin(),
-                 ie = call.params.end(); it != ie; ++it) {
+        for (SetuidFunctionParams::const_iterator it = call.params().begin(),
+                 ie = call.params().end(); it != ie; ++it) {
             std::stringstream ss;
             ss << static_cast<unsigned>(*it);
             l.push_back(ss.str());
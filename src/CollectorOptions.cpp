@@ -0,0 +1,186 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "CollectorOptions.h"
+
+#include "Util.h"
+
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+
+static unsigned defaultNumWorkers() {
+    long const numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    return numCPUs > 0 ? numCPUs : 1;
+}
+
+CollectorOptions::CollectorOptions() :
+    workers(defaultNumWorkers()),
+    checkpointInterval(300),
+    resume(false),
+    incremental(),
+    symmetric(false),
+    callClasses(false),
+    probeTimeout(30000),
+    cloneProbes(false),
+    forkTree(false),
+    sharedResults(false),
+    simulate(false),
+    semantics(CredentialModel::LinuxSemantics),
+    start(0, 0, 0) {}
+
+static bool parseUnsigned(std::string const& str, unsigned& value) {
+    try {
+        int const i = stoi(str.c_str(), NULL, 10);
+        if (i < 0) {
+            return false;
+        }
+        value = i;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Parse "ruid,euid,svuid"
+static bool parseState(std::string const& str, SetuidState& state) {
+    std::string::size_type const comma1 = str.find(',');
+    std::string::size_type const comma2 = comma1 == std::string::npos ?
+        std::string::npos : str.find(',', comma1 + 1);
+    if (comma2 == std::string::npos ||
+        str.find(',', comma2 + 1) != std::string::npos) {
+        return false;
+    }
+    try {
+        state = SetuidState(
+            stoi(str.substr(0, comma1).c_str(), NULL, 10),
+            stoi(str.substr(comma1 + 1, comma2 - comma1 - 1).c_str(), NULL, 10),
+            stoi(str.substr(comma2 + 1).c_str(), NULL, 10));
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+int parseCollectorOptions(int argc, char* argv[], CollectorOptions& options) {
+    bool workersGiven = false;
+    bool checkpointIntervalGiven = false;
+    bool probeTimeoutGiven = false;
+    bool startGiven = false;
+    int i = 1;
+    for (; i < argc; ++i) {
+        std::string const arg(argv[i]);
+        if (arg.compare(0, 2, "--") != 0) {
+            break;
+        }
+
+        std::string::size_type const eq = arg.find('=');
+        std::string const name = arg.substr(2, eq == std::string::npos ?
+                                            std::string::npos : eq - 2);
+        bool const hasValue = eq != std::string::npos;
+        std::string const value = hasValue ? arg.substr(eq + 1) : "";
+
+        if (name == "workers") {
+            if (!hasValue) {
+                options.workers = defaultNumWorkers();
+            } else if (!parseUnsigned(value, options.workers)) {
+                std::cerr << "ERROR: --workers expects a non-negative integer"
+                          << std::endl;
+                return -1;
+            }
+            workersGiven = true;
+        } else if (name == "checkpoint-interval") {
+            if (!hasValue || !parseUnsigned(value, options.checkpointInterval)) {
+                std::cerr << "ERROR: --checkpoint-interval expects a number of "
+                          << "seconds" << std::endl;
+                return -1;
+            }
+            checkpointIntervalGiven = true;
+        } else if (name == "probe-timeout") {
+            if (!hasValue || !parseUnsigned(value, options.probeTimeout)) {
+                std::cerr << "ERROR: --probe-timeout expects a number of "
+                          << "milliseconds" << std::endl;
+                return -1;
+            }
+            probeTimeoutGiven = true;
+        } else if (name == "resume" && !hasValue) {
+            options.resume = true;
+        } else if (name == "symmetric" && !hasValue) {
+            options.symmetric = true;
+        } else if (name == "call-classes" && !hasValue) {
+            options.callClasses = true;
+        } else if (name == "clone-probes" && !hasValue) {
+            options.cloneProbes = true;
+        } else if (name == "fork-tree" && !hasValue) {
+            options.forkTree = true;
+        } else if (name == "shared-results" && !hasValue) {
+            options.sharedResults = true;
+        } else if (name == "simulate") {
+            if (hasValue &&
+                !CredentialModel::parse(value, options.semantics)) {
+                std::cerr << "ERROR: --simulate expects \"linux\" or "
+                          << "\"posix\"" << std::endl;
+                return -1;
+            }
+            options.simulate = true;
+        } else if (name == "start") {
+            if (!hasValue || !parseState(value, options.start)) {
+                std::cerr << "ERROR: --start expects \"ruid,euid,svuid\""
+                          << std::endl;
+                return -1;
+            }
+            startGiven = true;
+        } else if (name == "incremental") {
+            if (!hasValue || value.empty()) {
+                std::cerr << "ERROR: --incremental expects an archive name"
+                          << std::endl;
+                return -1;
+            }
+            options.incremental = value;
+        } else {
+            std::cerr << "ERROR: Unknown option: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    if (startGiven && !options.simulate) {
+        std::cerr << "ERROR: --start only applies to --simulate; real "
+                  << "collections start from the collector's own state"
+                  << std::endl;
+        return -1;
+    }
+
+    if (options.sharedResults || probeTimeoutGiven || options.cloneProbes) {
+        if ((workersGiven && options.workers > 0) ||
+            options.forkTree || options.simulate) {
+            std::cerr << "ERROR: --shared-results, --probe-timeout and "
+                      << "--clone-probes only apply with --workers=0, and "
+                      << "without --fork-tree or --simulate" << std::endl;
+            return -1;
+        }
+        options.workers = 0;
+    }
+
+    // Symmetric and fork-tree explorations keep no frontier to save
+    if ((checkpointIntervalGiven || options.resume) &&
+        (options.symmetric || options.forkTree)) {
+        std::cerr << "ERROR: --checkpoint-interval and --resume cannot be "
+                  << "combined with --symmetric or --fork-tree" << std::endl;
+        return -1;
+    }
+    return i;
+}
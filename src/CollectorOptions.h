@@ -0,0 +1,76 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "CredentialModel.h"
+
+#include <string>
+
+// Options shared by the Collect*Data tools. Options come before the
+// positional arguments and take the form "--name" or "--name=value".
+struct CollectorOptions {
+    CollectorOptions();
+
+    // Size of the exploration worker pool; 0 forks per state and per call.
+    // --shared-results, --probe-timeout and --clone-probes only apply to
+    // forking per state, so they select it
+    unsigned workers;
+
+    // Seconds between checkpoints; 0 disables checkpointing
+    unsigned checkpointInterval;
+
+    // Continue from the last checkpoint, if there is one
+    bool resume;
+
+    // Archive name (without ".archive") of an earlier collection over a
+    // subset of the UIDs and params; only what it is missing is collected
+    std::string incremental;
+
+    // Explore one representative per orbit of unprivileged UID permutations
+    bool symmetric;
+
+    // Probe one call per class of calls that behave alike from a state
+    bool callClasses;
+
+    // Milliseconds before a hung call exploration is killed and retried;
+    // 0 waits forever
+    unsigned probeTimeout;
+
+    // Make setuid-family calls in clone()d probes instead of forks
+    bool cloneProbes;
+
+    // Explore depth-first from nested forks instead of replaying paths
+    bool forkTree;
+
+    // Without workers, have forked explorations report through shared
+    // memory instead of a pipe each
+    bool sharedResults;
+
+    // Explore a model of the kernel's credentials (with the given
+    // semantics) instead of making real calls
+    bool simulate;
+    CredentialModel::Semantics semantics;
+
+    // State a simulated exploration starts from, given as "ruid,euid,svuid";
+    // real explorations start from the collector's own state
+    SetuidState start;
+};
+
+// Parse leading options from argv, starting after the program name. Returns
+// the index of the first positional argument, or -1 (after reporting the
+// problem on stderr) if an option is malformed.
+int parseCollectorOptions(int argc, char* argv[], CollectorOptions& options);
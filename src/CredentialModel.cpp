@@ -0,0 +1,159 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "CredentialModel.h"
+
+#include "Assertions.h"
+
+#include <errno.h>
+
+static UID const unchanged = 0 - 1;
+
+static bool isPrivileged(SetuidState const& ss) {
+    return ss.euid == 0;
+}
+
+static bool isHeld(SetuidState const& ss, UID uid) {
+    return uid == ss.ruid || uid == ss.euid || uid == ss.svuid;
+}
+
+static SetuidFunctionReturn succeed() {
+    return SetuidFunctionReturn(0, 0);
+}
+
+static SetuidFunctionReturn fail(int errNumber) {
+    return SetuidFunctionReturn(-1, errNumber);
+}
+
+SetuidFunctionReturn CredentialModel::apply(
+    SetuidState& ss,
+    SetuidFunction function,
+    SetuidFunctionParams const& params) const {
+    switch (function) {
+    default:
+        ASSERT(false);
+        return fail(ENOSYS);
+    case Setuid:
+        ASSERT(params.size() == 1);
+        return setuid(ss, params.at(0));
+    case Seteuid:
+        ASSERT(params.size() == 1);
+        return seteuid(ss, params.at(0));
+    case Setreuid:
+        ASSERT(params.size() == 2);
+        return setreuid(ss, params.at(0), params.at(1));
+    case Setresuid:
+        ASSERT(params.size() == 3);
+        return setresuid(ss, params.at(0), params.at(1), params.at(2));
+    }
+}
+
+bool CredentialModel::parse(std::string const& name, Semantics& semantics) {
+    if (name == "linux") {
+        semantics = LinuxSemantics;
+        return true;
+    } else if (name == "posix") {
+        semantics = PosixSemantics;
+        return true;
+    }
+    return false;
+}
+
+SetuidFunctionReturn CredentialModel::setuid(SetuidState& ss, UID uid) const {
+    if (uid == unchanged) {
+        return fail(EINVAL);
+    }
+    if (isPrivileged(ss)) {
+        ss = SetuidState(uid, uid, uid);
+    } else if (uid == ss.ruid || uid == ss.svuid) {
+        ss.euid = uid;
+    } else {
+        return fail(EPERM);
+    }
+    return succeed();
+}
+
+// glibc rejects -1 before asking the kernel for setresuid(-1, euid, -1),
+// which also lets an unprivileged process keep its effective UID; POSIX
+// only allows the real or saved UID
+SetuidFunctionReturn CredentialModel::seteuid(SetuidState& ss, UID euid) const {
+    if (euid == unchanged) {
+        return fail(EINVAL);
+    }
+    bool const permitted = semantics == LinuxSemantics ?
+        isHeld(ss, euid) : (euid == ss.ruid || euid == ss.svuid);
+    if (!isPrivileged(ss) && !permitted) {
+        return fail(EPERM);
+    }
+    ss.euid = euid;
+    return succeed();
+}
+
+// The saved UID follows the new effective UID whenever the real UID is set
+// or the effective UID is set to something other than the old real UID
+SetuidFunctionReturn CredentialModel::setreuid(
+    SetuidState& ss,
+    UID ruid,
+    UID euid) const {
+    if (!isPrivileged(ss)) {
+        if (ruid != unchanged && ruid != ss.ruid && ruid != ss.euid) {
+            return fail(EPERM);
+        }
+        if (euid != unchanged && !isHeld(ss, euid)) {
+            return fail(EPERM);
+        }
+    }
+
+    SetuidState next = ss;
+    if (ruid != unchanged) {
+        next.ruid = ruid;
+    }
+    if (euid != unchanged) {
+        next.euid = euid;
+    }
+    if (ruid != unchanged || (euid != unchanged && euid != ss.ruid)) {
+        next.svuid = next.euid;
+    }
+    ss = next;
+    return succeed();
+}
+
+SetuidFunctionReturn CredentialModel::setresuid(
+    SetuidState& ss,
+    UID ruid,
+    UID euid,
+    UID svuid) const {
+    if (semantics == PosixSemantics) {
+        return fail(ENOSYS);
+    }
+    if (!isPrivileged(ss) &&
+        ((ruid != unchanged && !isHeld(ss, ruid)) ||
+         (euid != unchanged && !isHeld(ss, euid)) ||
+         (svuid != unchanged && !isHeld(ss, svuid)))) {
+        return fail(EPERM);
+    }
+
+    if (ruid != unchanged) {
+        ss.ruid = ruid;
+    }
+    if (euid != unchanged) {
+        ss.euid = euid;
+    }
+    if (svuid != unchanged) {
+        ss.svuid = svuid;
+    }
+    return succeed();
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "SetuidState.h"
+
+#include <string>
+
+// A model of how the kernel updates a process's user IDs, so that graphs
+// can be explored without making real calls (or being root).
+//
+// Privilege is having an effective UID of 0: a process that starts out as
+// root keeps CAP_SETUID exactly while its effective UID is 0. Only the
+// setuid-family calls are modeled; the priv wrappers also change groups.
+class CredentialModel {
+public:
+    enum Semantics {
+        // Linux, as seen through glibc
+        LinuxSemantics,
+        // What POSIX requires of setuid(), seteuid() and setreuid(); there
+        // is no setresuid()
+        PosixSemantics,
+    };
+
+    explicit CredentialModel(Semantics _semantics = LinuxSemantics) :
+        semantics(_semantics) {}
+
+    Semantics getSemantics() const { return semantics; }
+
+    // Make a call from ss, leaving ss as the call would; the return is what
+    // the call would have returned
+    SetuidFunctionReturn apply(
+        SetuidState& ss,
+        SetuidFunction function,
+        SetuidFunctionParams const& params) const;
+
+    // "linux" or "posix"
+    static bool parse(std::string const& name, Semantics& semantics);
+
+private:
+    Semantics semantics;
+
+    SetuidFunctionReturn setuid(SetuidState& ss, UID uid) const;
+    SetuidFunctionReturn seteuid(SetuidState& ss, UID euid) const;
+    SetuidFunctionReturn setreuid(SetuidState& ss, UID ruid, UID euid) const;
+    SetuidFunctionReturn setresuid(
+        SetuidState& ss,
+        UID ruid,
+        UID euid,
+        UID svuid) const;
+};
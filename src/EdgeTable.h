@@ -0,0 +1,88 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "FrozenGraph.h"
+#include "SetuidState.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+// The edges of a FrozenSetuidStateGraph as columns: one array per field, one row per call made
+// from a state reachable from the start state. Rows are in the order the
+// FusedVerifier checks edges: states in order, each state's out-edges and
+// then its failed calls; each row keeps its vertex index and edge number, so
+// rows can be reported to a ViolationSink and described by a
+// FusedVerifierDescriber.
+//
+// Every column holds 32-bit signed values. UIDs are stored as their bits, so
+// UID -1 reads as -1 and compares equal to a param of -1; params a function
+// does not take read as -1. Functions are SetuidFunction values.
+//
+// Columns are padded to a whole number of chunks of chunkSize rows, so that
+// loops over a chunk always have the same, constant trip count.
+class EdgeTable {
+public:
+    static unsigned const chunkSize = 1024;
+
+    typedef int32_t Value;
+    typedef std::vector<Value> Column;
+
+    enum ColumnId {
+        PreRuid,
+        PreEuid,
+        PreSvuid,
+        PostRuid,
+        PostEuid,
+        PostSvuid,
+        Function,
+        Param1,
+        Param2,
+        Param3,
+        Return,
+        Errno,
+        NumColumns,
+    };
+
+    static unsigned const numParams = 3;
+
+    template<typename Graph>
+    explicit EdgeTable(Graph const& g);
+
+    // Rows, not counting padding
+    unsigned size() const { return vertices.size(); }
+
+    Column const& getColumn(ColumnId id) const { return columns[id]; }
+    std::vector<unsigned> const& getVertices() const { return vertices; }
+    std::vector<unsigned> const& getEdges() const { return edges; }
+
+private:
+    Column columns[NumColumns];
+    std::vector<unsigned> vertices;
+    std::vector<unsigned> edges;
+
+    template<typename VertexProperty, typename EdgeProperty>
+    void append(
+        EdgeProperty const& e,
+        VertexProperty const& s1,
+        VertexProperty const& s2,
+        unsigned vertex,
+        unsigned edge);
+};
+
+#include "EdgeTableImpl.h"
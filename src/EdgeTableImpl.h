@@ -0,0 +1,84 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "EdgeTable.h"
+
+template<typename Graph>
+EdgeTable::EdgeTable(Graph const& g) {
+    typedef typename Graph::Graph BoostGraph;
+    typedef typename Graph::Vertex Vertex;
+    typedef typename Graph::EdgePropertyList EdgePropertyList;
+
+    BoostGraph const& boostGraph = g.getGraph();
+    unsigned const numVertices = g.getNumVertices();
+    for (Vertex v = 0; v < numVertices; ++v) {
+        if (!g.isReachable(v)) {
+            continue;
+        }
+        typename Graph::VertexPropertyType const& s = boostGraph[v];
+        unsigned edge = 0;
+        typename Graph::EdgeIteratorPair edgeRange =
+            boost::out_edges(v, boostGraph);
+        for (; edgeRange.first != edgeRange.second; ++edgeRange.first, ++edge) {
+            append(
+                boostGraph[*edgeRange.first],
+                s,
+                boostGraph[boost::target(*edgeRange.first, boostGraph)],
+                v,
+                edge);
+        }
+        EdgePropertyList const failed = g.getFailedEdges(v);
+        for (typename EdgePropertyList::const_iterator
+                 it = failed.begin(), ie = failed.end();
+             it != ie; ++it, ++edge) {
+            append(*it, s, s, v, edge);
+        }
+    }
+
+    unsigned const padded = (size() + chunkSize - 1) / chunkSize * chunkSize;
+    for (unsigned i = 0; i < NumColumns; ++i) {
+        columns[i].resize(padded);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty>
+void EdgeTable::append(
+    EdgeProperty const& e,
+    VertexProperty const& s1,
+    VertexProperty const& s2,
+    unsigned vertex,
+    unsigned edge) {
+    columns[PreRuid].push_back(static_cast<Value>(s1.ruid));
+    columns[PreEuid].push_back(static_cast<Value>(s1.euid));
+    columns[PreSvuid].push_back(static_cast<Value>(s1.svuid));
+    columns[PostRuid].push_back(static_cast<Value>(s2.ruid));
+    columns[PostEuid].push_back(static_cast<Value>(s2.euid));
+    columns[PostSvuid].push_back(static_cast<Value>(s2.svuid));
+    columns[Function].push_back(static_cast<Value>(e.function()));
+
+    SetuidFunctionParams const& params = e.params();
+    for (unsigned i = 0; i < numParams; ++i) {
+        columns[Param1 + i].push_back(
+            i < params.size() ? static_cast<Value>(params[i]) : -1);
+    }
+
+    columns[Return].push_back(static_cast<Value>(e.rtn.value));
+    columns[Errno].push_back(static_cast<Value>(e.rtn.errNumber));
+    vertices.push_back(vertex);
+    edges.push_back(edge);
+}
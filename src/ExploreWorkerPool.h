@@ -0,0 +1,183 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "Channel.h"
+#include "Fork.h"
+#include "Graph.h"
+
+#include <signal.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include <boost/serialization/list.hpp>
+
+namespace boost { namespace serialization { class access; } }
+
+template<
+    typename VertexProperty,
+    typename EdgeProperty,
+    typename VertexGeneratorType,
+    typename EdgeGeneratorType>
+class GraphExplorer;
+
+// Persistent pool of worker processes for individual (state, call) probes.
+//
+// Workers are forked once, up front, from the (root) explorer. Each worker
+// reads jobs from its own command pipe; all workers (and their children)
+// report results on a single shared result pipe, which the explorer drains
+// in completion order. For a probe that cannot drop the worker's privileges,
+// the worker jumps to the state and makes the call itself, then jumps back;
+// otherwise it forks a short-lived child for the single call. A worker that
+// unexpectedly loses its privileges anyway reports its result, retires, and
+// is replaced. A worker that dies is replaced too, and the job it held is
+// handed back to the explorer as failed.
+template<
+    typename VertexProperty,
+    typename EdgeProperty,
+    typename VertexGeneratorType,
+    typename EdgeGeneratorType>
+class ExploreWorkerPool {
+public:
+    typedef GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType> Explorer;
+    typedef typename SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::PathStep PathStep;
+    typedef typename SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::Path Path;
+    typedef typename EdgeGeneratorType::OutputItem Call;
+
+    struct Job {
+        friend class boost::serialization::access;
+
+        Job() : id(0), state(), call(), hasPath(false), path() {}
+        Job(unsigned _id, VertexProperty const& _state, Call const& _call) :
+            id(_id), state(_state), call(_call), hasPath(false), path() {}
+
+        unsigned id;
+        VertexProperty state;
+        Call call;
+        // States that cannot be jumped to are reached by replaying a path
+        // from the start state
+        bool hasPath;
+        Path path;
+
+    private:
+        template<class Archive>
+        void serialize(Archive& ar, unsigned int const version) {
+            ar & id;
+            ar & state;
+            ar & call;
+            ar & hasPath;
+            ar & path;
+        }
+    };
+
+    struct Result {
+        friend class boost::serialization::access;
+
+        Result() : id(0), ok(false), retiring(false), step() {}
+        Result(unsigned _id, bool _ok, bool _retiring, PathStep const& _step) :
+            id(_id), ok(_ok), retiring(_retiring), step(_step) {}
+
+        unsigned id;
+        // False if the probe died before reporting; the job should be retried
+        bool ok;
+        // Set when the reporting worker has lost its privileges and exits
+        bool retiring;
+        PathStep step;
+
+    private:
+        template<class Archive>
+        void serialize(Archive& ar, unsigned int const version) {
+            ar & id;
+            ar & ok;
+            ar & retiring;
+            ar & step;
+        }
+    };
+
+    ExploreWorkerPool(Explorer& _e, unsigned _size) :
+        e(_e),
+        poolSize(_size),
+        workers(),
+        resultRead(-1),
+        resultWrite(-1),
+        savedSigpipe() {}
+
+    virtual ~ExploreWorkerPool() { stop(); }
+
+    // Fork all workers; returns the number of workers running
+    unsigned start();
+
+    void stop();
+
+    unsigned size() const { return workers.size(); }
+    unsigned numBusy() const;
+    bool hasIdleWorker() const { return numBusy() < workers.size(); }
+
+    // Hand a job to an idle worker
+    void submit(Job const& job);
+
+    // Block until the next result arrives (from any worker), or until a
+    // busy worker dies; its job is then returned as not ok
+    Result collect();
+
+private:
+    struct Worker {
+        Worker() : pid(-1), pidFd(-1), cmdFd(-1), busy(false), jobId(0) {}
+
+        // -1 once the worker has died and been reaped
+        pid_t pid;
+        FileDescriptor pidFd;
+        FileDescriptor cmdFd;
+        bool busy;
+        unsigned jobId;
+    };
+
+    Explorer& e;
+    unsigned const poolSize;
+    std::vector<Worker> workers;
+    FileDescriptor resultRead;
+    FileDescriptor resultWrite;
+    struct sigaction savedSigpipe;
+
+    // Milliseconds between checks on workers that have no pidfd to watch
+    static int const reapInterval = 100;
+
+    bool spawn(Worker& w);
+    void respawn(Worker& w);
+
+    // Wait until a result can be read or a worker may have died; true if a
+    // result can be read
+    bool waitForResult();
+    bool resultPending();
+    // False if the next frame could not be read or decoded
+    bool readResult(Result& result);
+    // Recover from an unreadable result, which leaves the result pipe out
+    // of step: kill the busy workers, whose jobs collect() then hands back
+    // as failed, and drop whatever is left in the pipe
+    void discardResults();
+
+    // Reap workers that have died, marking them with a pid of -1
+    void reapWorkers();
+
+    void serve(FileDescriptor cmdFd, VertexProperty const& initial);
+    void probeInProcess(Job const& job, VertexProperty const& initial);
+    void probeInChild(Job const& job);
+    void report(Result const& result);
+};
+
+#include "ExploreWorkerPoolImpl.h"
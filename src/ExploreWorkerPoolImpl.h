@@ -0,0 +1,392 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "Assertions.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+unsigned ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::start() {
+    ASSERT(workers.empty());
+
+    FileDescriptor fd[2];
+    if (pipe(fd) == -1) {
+        return 0;
+    }
+    resultRead = fd[0];
+    resultWrite = fd[1];
+
+    // A worker that dies leaves its command pipe without a reader; handing
+    // it a job should fail rather than kill the explorer
+    struct sigaction ignore;
+    std::memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, &savedSigpipe);
+
+    for (unsigned i = 0; i < poolSize; ++i) {
+        workers.push_back(Worker());
+        if (!spawn(workers.back())) {
+            workers.pop_back();
+            break;
+        }
+    }
+    return workers.size();
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::stop() {
+    // Workers exit when they see end-of-file on their command pipes
+    for (typename std::vector<Worker>::iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        close(it->cmdFd);
+    }
+    for (typename std::vector<Worker>::iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        if (it->pid != -1) {
+            waitpid(it->pid, NULL, 0);
+        }
+        if (it->pidFd != -1) {
+            close(it->pidFd);
+        }
+    }
+    workers.clear();
+
+    if (resultRead != -1) {
+        close(resultRead);
+        close(resultWrite);
+        resultRead = resultWrite = -1;
+        sigaction(SIGPIPE, &savedSigpipe, NULL);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+unsigned ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::numBusy() const {
+    unsigned busy = 0;
+    for (typename std::vector<Worker>::const_iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        if (it->busy) {
+            ++busy;
+        }
+    }
+    return busy;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::submit(
+    Job const& job) {
+    for (typename std::vector<Worker>::iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        if (it->busy) {
+            continue;
+        }
+        // Each worker holds at most one job, so its command pipe never
+        // fills up
+        while (!writeFrame(it->cmdFd, archiveToString(job))) {
+            std::cerr << "Worker pool: lost a worker; respawning..."
+                      << std::endl;
+            respawn(*it);
+        }
+        it->busy = true;
+        it->jobId = job.id;
+        return;
+    }
+    ASSERT(false);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+typename ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::Result
+ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::collect() {
+    ASSERT(numBusy() > 0);
+
+    // The explorer holds the write end of the result pipe too, so reading
+    // never sees end-of-file; dead workers are found by watching for them
+    for (;;) {
+        if (waitForResult()) {
+            Result result;
+            if (readResult(result)) {
+                return result;
+            }
+            discardResults();
+            continue;
+        }
+
+        reapWorkers();
+        // A worker may have reported just before it died
+        if (resultPending()) {
+            continue;
+        }
+
+        for (typename std::vector<Worker>::iterator it = workers.begin(),
+                 ie = workers.end(); it != ie; ++it) {
+            if (it->pid != -1) {
+                continue;
+            }
+            bool const wasBusy = it->busy;
+            unsigned const jobId = it->jobId;
+            std::cerr << "Worker pool: lost a worker; respawning..."
+                      << std::endl;
+            respawn(*it);
+            if (wasBusy) {
+                // Let the explorer requeue the job
+                return Result(jobId, false, false, PathStep());
+            }
+        }
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::waitForResult() {
+    std::vector<struct pollfd> fds;
+    struct pollfd pfd;
+    pfd.fd = resultRead;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    fds.push_back(pfd);
+
+    int timeout = -1;
+    for (typename std::vector<Worker>::const_iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        if (it->pid == -1) {
+            // Already dead; only wait on results that are already in
+            timeout = 0;
+        } else if (it->pidFd == -1) {
+            if (timeout == -1) {
+                timeout = reapInterval;
+            }
+        } else {
+            pfd.fd = it->pidFd;
+            fds.push_back(pfd);
+        }
+    }
+
+    if (poll(&fds[0], fds.size(), timeout) == -1) {
+        ASSERT(errno == EINTR);
+        return false;
+    }
+    return fds[0].revents != 0;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::resultPending() {
+    struct pollfd pfd;
+    pfd.fd = resultRead;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return poll(&pfd, 1, 0) == 1;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::readResult(
+    Result& result) {
+    std::string payload;
+    if (!readFrame(resultRead, payload) ||
+        !archiveFromString(payload, result)) {
+        return false;
+    }
+
+    for (typename std::vector<Worker>::iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        if (!it->busy || it->jobId != result.id) {
+            continue;
+        }
+        it->busy = false;
+        if (result.retiring) {
+            respawn(*it);
+        }
+        break;
+    }
+    return true;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::discardResults() {
+    std::cerr << "Worker pool: unreadable result; restarting busy workers..."
+              << std::endl;
+    for (typename std::vector<Worker>::iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        if (it->busy && it->pid != -1) {
+            kill(it->pid, SIGKILL);
+            while (waitpid(it->pid, NULL, 0) == -1 && errno == EINTR) {}
+            it->pid = -1;
+        }
+    }
+    char buffer[PIPE_BUF];
+    while (resultPending() &&
+           read(resultRead, buffer, sizeof(buffer)) > 0) {}
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::reapWorkers() {
+    for (typename std::vector<Worker>::iterator it = workers.begin(),
+             ie = workers.end(); it != ie; ++it) {
+        if (it->pid != -1 && waitpid(it->pid, NULL, WNOHANG) == it->pid) {
+            it->pid = -1;
+        }
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::spawn(
+    Worker& w) {
+    FileDescriptor fd[2];
+    if (pipe(fd) == -1) {
+        return false;
+    }
+
+    // Workers return to this state between jobs
+    VertexProperty const initial = VertexProperty::get();
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(fd[0]);
+        close(fd[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        // Worker: drop every pipe end that belongs to the explorer so that
+        // other workers see end-of-file when the explorer lets them go
+        close(fd[1]);
+        close(resultRead);
+        for (typename std::vector<Worker>::const_iterator it = workers.begin(),
+                 ie = workers.end(); it != ie; ++it) {
+            if (it->cmdFd != -1) {
+                close(it->cmdFd);
+            }
+            if (it->pidFd != -1) {
+                close(it->pidFd);
+            }
+        }
+        serve(fd[0], initial);
+        exit(0);
+    }
+
+    close(fd[0]);
+    w.pid = pid;
+    w.pidFd = openPidDescriptor(pid);
+    w.cmdFd = fd[1];
+    w.busy = false;
+    w.jobId = 0;
+    return true;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::respawn(
+    Worker& w) {
+    close(w.cmdFd);
+    w.cmdFd = -1;
+    if (w.pid != -1) {
+        waitpid(w.pid, NULL, 0);
+        w.pid = -1;
+    }
+    if (w.pidFd != -1) {
+        close(w.pidFd);
+        w.pidFd = -1;
+    }
+    while (!spawn(w)) {
+        std::cerr << "Worker pool: pipe/fork failed. Retrying..."
+                  << std::endl;
+        e.forkController.backoff();
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::serve(
+    FileDescriptor cmdFd, VertexProperty const& initial) {
+    std::string payload;
+    while (readFrame(cmdFd, payload)) {
+        Job job;
+        if (!archiveFromString(payload, job)) {
+            // Exiting hands the job back to the explorer
+            break;
+        }
+
+        if (!job.hasPath &&
+            e.canJumpToVertex(initial) &&
+            !e.mayLosePrivilege(job.state, job.call)) {
+            probeInProcess(job, initial);
+        } else {
+            probeInChild(job);
+        }
+    }
+    close(cmdFd);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::probeInProcess(
+    Job const& job, VertexProperty const& initial) {
+    e.jumpToVertex(job.state);
+    ASSERT(VertexProperty::get() == job.state);
+    EdgeProperty const edge = e.exploreEdge(job.call);
+    VertexProperty const nextVertex = VertexProperty::get();
+
+    e.jumpToVertex(initial);
+    bool const retiring = !(VertexProperty::get() == initial);
+
+    report(Result(job.id, true, retiring, PathStep(edge, nextVertex)));
+    if (retiring) {
+        exit(0);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::probeInChild(
+    Job const& job) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (job.hasPath) {
+            e.followPath(job.path);
+        } else {
+            e.jumpToVertex(job.state);
+        }
+        ASSERT(VertexProperty::get() == job.state);
+        EdgeProperty const edge = e.exploreEdge(job.call);
+        VertexProperty const nextVertex = VertexProperty::get();
+        report(Result(job.id, true, false, PathStep(edge, nextVertex)));
+        exit(0);
+    }
+
+    int status = 0;
+    if (pid != -1) {
+        while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {}
+    }
+    if (pid == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        // Let the explorer requeue the job
+        report(Result(job.id, false, false, PathStep()));
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::report(
+    Result const& result) {
+    std::string const payload = archiveToString(result);
+    ASSERT(payload.size() <= maxAtomicFramePayload());
+    bool const written = writeFrame(resultWrite, payload);
+    ASSERT(written);
+    (void)written;
+}
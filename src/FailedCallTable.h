@@ -0,0 +1,128 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "SetuidState.h"
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include <boost/serialization/vector.hpp>
+
+namespace boost { namespace serialization { class access; } }
+
+// The calls that failed in each state. A failed call leaves the state as it
+// was, so in a graph it is a self-loop; most calls fail in most states, so
+// storing them as edges would make up most of the graph.
+//
+// Instead, each distinct failed call (with its return value cleared) is
+// numbered once per table, and a state keeps a bitmap over those numbers plus
+// the return value and errno of each failure, in bit order. A call can fail
+// at most once per state; adding it again replaces its return value.
+template<typename EdgeProperty>
+class FailedCallTable {
+public:
+    friend class boost::serialization::access;
+
+    typedef std::vector<EdgeProperty> EdgePropertyList;
+
+    FailedCallTable() {}
+    explicit FailedCallTable(unsigned numVertices) :
+        bitmaps(numVertices), codes(numVertices) {}
+
+    // Whether an edge from a state back to itself is a failure to be stored
+    // here rather than as an edge
+    static bool isFailure(EdgeProperty const& e) { return e.rtn.value != 0; }
+
+    void add(unsigned vertexIdx, EdgeProperty const& e);
+
+    // The failed calls of a state, as the edges they stand for
+    EdgePropertyList get(unsigned vertexIdx) const;
+    bool empty(unsigned vertexIdx) const {
+        return codes.at(vertexIdx).empty();
+    }
+
+    // Replace each call by f(call); f must map distinct calls to distinct
+    // calls, so that calls keep their numbers (and states their failures)
+    template<typename Function>
+    void mapCalls(Function const& f);
+
+    unsigned getNumVertices() const { return bitmaps.size(); }
+    unsigned getNumCalls() const { return calls.size(); }
+
+private:
+    typedef uint64_t Word;
+    typedef std::vector<Word> Bitmap;
+
+    static unsigned const wordBits = 64;
+
+    struct FailureCode {
+        friend class boost::serialization::access;
+
+        FailureCode() : value(-1), errNumber(-1) {}
+        FailureCode(short _value, short _errNumber) :
+            value(_value), errNumber(_errNumber) {}
+
+        short value;
+        short errNumber;
+
+    private:
+        template<class Archive>
+        void serialize(Archive& ar, unsigned int const version) {
+            ar & value;
+            ar & errNumber;
+        }
+    };
+    typedef std::vector<FailureCode> FailureCodeList;
+
+    // Calls are numbered by (call, rtn) alone: weights are not archived, so
+    // a call loaded with weight 0 must find the number it was given when it
+    // was probed with weight 1
+    struct CallLess {
+        bool operator()(EdgeProperty const& e1, EdgeProperty const& e2) const {
+            return e1.call < e2.call || (e1.call == e2.call && e1.rtn < e2.rtn);
+        }
+    };
+    typedef std::map<EdgeProperty, unsigned, CallLess> CallIndex;
+
+    EdgePropertyList calls;
+    CallIndex callIdx;
+    std::vector<Bitmap> bitmaps;
+    std::vector<FailureCodeList> codes;
+
+    unsigned internCall(EdgeProperty const& e);
+
+    // Position of call's failure code among the state's codes
+    static unsigned rank(Bitmap const& bitmap, unsigned call);
+
+    template<class Archive>
+    void serialize(Archive& ar, unsigned int const version) {
+        ar & calls;
+        ar & bitmaps;
+        ar & codes;
+        if (Archive::is_loading::value) {
+            callIdx.clear();
+            for (unsigned i = 0; i < calls.size(); ++i) {
+                callIdx.insert(std::make_pair(calls.at(i), i));
+            }
+        }
+    }
+};
+
+#include "FailedCallTableImpl.h"
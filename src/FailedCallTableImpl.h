@@ -0,0 +1,102 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "Assertions.h"
+
+template<typename EdgeProperty>
+void FailedCallTable<EdgeProperty>::add(
+    unsigned vertexIdx,
+    EdgeProperty const& e) {
+    ASSERT(isFailure(e));
+    unsigned const call = internCall(e);
+    Bitmap& bitmap = bitmaps.at(vertexIdx);
+    FailureCodeList& vertexCodes = codes.at(vertexIdx);
+    unsigned const word = call / wordBits;
+    Word const bit = static_cast<Word>(1) << (call % wordBits);
+    if (bitmap.size() <= word) {
+        bitmap.resize(word + 1, 0);
+    }
+
+    FailureCode const code(e.rtn.value, e.rtn.errNumber);
+    unsigned const pos = rank(bitmap, call);
+    if (bitmap[word] & bit) {
+        vertexCodes.at(pos) = code;
+    } else {
+        bitmap[word] |= bit;
+        vertexCodes.insert(vertexCodes.begin() + pos, code);
+    }
+}
+
+template<typename EdgeProperty>
+typename FailedCallTable<EdgeProperty>::EdgePropertyList
+FailedCallTable<EdgeProperty>::get(unsigned vertexIdx) const {
+    Bitmap const& bitmap = bitmaps.at(vertexIdx);
+    FailureCodeList const& vertexCodes = codes.at(vertexIdx);
+    EdgePropertyList edges;
+    edges.reserve(vertexCodes.size());
+    unsigned pos = 0;
+    for (unsigned word = 0; word < bitmap.size(); ++word) {
+        for (Word w = bitmap[word]; w != 0; w &= w - 1) {
+            unsigned const call = word * wordBits + __builtin_ctzll(w);
+            FailureCode const& code = vertexCodes.at(pos++);
+            EdgeProperty e = calls.at(call);
+            e.rtn.value = code.value;
+            e.rtn.errNumber = code.errNumber;
+            edges.push_back(e);
+        }
+    }
+    return edges;
+}
+
+template<typename EdgeProperty>
+template<typename Function>
+void FailedCallTable<EdgeProperty>::mapCalls(Function const& f) {
+    callIdx.clear();
+    for (unsigned i = 0; i < calls.size(); ++i) {
+        calls[i] = f(calls[i]);
+        callIdx.insert(std::make_pair(calls[i], i));
+    }
+    ASSERT(callIdx.size() == calls.size());
+}
+
+template<typename EdgeProperty>
+unsigned FailedCallTable<EdgeProperty>::internCall(EdgeProperty const& e) {
+    EdgeProperty key = e;
+    key.rtn = SetuidFunctionReturn();
+    typename CallIndex::const_iterator it = callIdx.find(key);
+    if (it != callIdx.end()) {
+        return it->second;
+    }
+    unsigned const call = calls.size();
+    calls.push_back(key);
+    callIdx.insert(std::make_pair(key, call));
+    return call;
+}
+
+template<typename EdgeProperty>
+unsigned FailedCallTable<EdgeProperty>::rank(
+    Bitmap const& bitmap,
+    unsigned call) {
+    unsigned const word = call / wordBits;
+    unsigned pos = 0;
+    for (unsigned i = 0; i < word; ++i) {
+        pos += __builtin_popcountll(bitmap[i]);
+    }
+    Word const below = (static_cast<Word>(1) << (call % wordBits)) - 1;
+    return pos + __builtin_popcountll(bitmap[word] & below);
+}
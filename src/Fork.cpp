@@ -0,0 +1,85 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "Fork.h"
+
+#include "Assertions.h"
+#include "Platform.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+ForkCounters& forkCounters() {
+    static ForkCounters* counters = NULL;
+    if (counters == NULL) {
+        void* const shared = mmap(
+            NULL,
+            sizeof(ForkCounters),
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANON,
+            -1,
+            0);
+        ASSERT(shared != MAP_FAILED);
+        counters = static_cast<ForkCounters*>(shared);
+        counters->reaped = 0;
+        counters->timedOut = 0;
+        counters->retried = 0;
+        counters->givenUp = 0;
+    }
+    return *counters;
+}
+
+std::ostream& operator<<(std::ostream& os, ForkCounters const& fc) {
+    os << fc.reaped << " reaped, " << fc.timedOut << " timed out, "
+       << fc.retried << " retried, " << fc.givenUp << " given up";
+    return os;
+}
+
+long monotonicMillis() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+FileDescriptor openPidDescriptor(pid_t pid) {
+
+#if IS_LINUX && defined(SYS_pidfd_open)
+
+    return syscall(SYS_pidfd_open, pid, 0);
+
+#else
+
+    return -1;
+
+#endif
+
+}
+
+unsigned forkDescriptors() {
+
+#if IS_LINUX && defined(SYS_pidfd_open)
+
+    return 2;
+
+#else
+
+    return 1;
+
+#endif
+
+}
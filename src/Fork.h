@@ -16,9 +16,36 @@
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
+#include "Channel.h"
+
 #include <sys/types.h>
 
-typedef int FileDescriptor;
+#include <iostream>
+
+// Counts of what happened to forked children, shared by every process
+// descended from the one that first asks for them (so that children's
+// probes are counted too)
+struct ForkCounters {
+    unsigned long reaped;
+    unsigned long timedOut;
+    unsigned long retried;
+    // Probes abandoned after their retries ran out
+    unsigned long givenUp;
+};
+
+ForkCounters& forkCounters();
+std::ostream& operator<<(std::ostream& os, ForkCounters const& fc);
+
+// Milliseconds on a clock that only moves forward
+long monotonicMillis();
+
+// A descriptor that becomes readable when pid exits, or -1 where pidfds are
+// not available
+FileDescriptor openPidDescriptor(pid_t pid);
+
+// Descriptors an in-flight Fork holds in its parent: the read end of its
+// pipe, plus a pidfd where openPidDescriptor() provides one
+unsigned forkDescriptors();
 
 template<typename Functor>
 class Fork {
@@ -26,25 +53,41 @@ public:
     Fork(Functor f) :
         functor(f),
         fdRead(-1),
+        pidFd(-1),
+        timeout(0),
         hasRun(false),
         hasRead(false),
-        readValue() {}
+        hasReaped(false),
+        readValue(),
+        childPID(-1),
+        childStatus(0) {}
+
+    // Give up on a child that has not reported after this many
+    // milliseconds; 0 waits forever
+    void setTimeout(unsigned millis) { timeout = millis; }
 
     FileDescriptor run(typename Functor::Param const& p);
 
-    typename Functor::Rtn read();
+    // Wait for the child's result; false if it timed out (and was killed)
+    // or exited without a complete one. Either way, the child has been
+    // reaped
+    bool tryRead(typename Functor::Rtn& rtn);
 
     int wait();
 
-    typename Functor::Rtn operator() (typename Functor::Param const& p);
-
 private:
     Functor functor;
     FileDescriptor fdRead;
+    FileDescriptor pidFd;
+    unsigned timeout;
     bool hasRun;
     bool hasRead;
+    bool hasReaped;
     typename Functor::Rtn readValue;
     pid_t childPID;
+    int childStatus;
+
+    void finish();
 };
 
 // Fork functors should typedef Rtn and Param appropriately
@@ -0,0 +1,101 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "ForkConcurrencyController.h"
+
+#include <errno.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+unsigned const ForkConcurrencyController::processorOversubscription;
+unsigned const ForkConcurrencyController::maxForks;
+unsigned const ForkConcurrencyController::reservedDescriptors;
+long const ForkConcurrencyController::minBackoffNanos;
+long const ForkConcurrencyController::maxBackoffNanos;
+
+// Soft limit for resource, or 0 if unlimited (or unknown)
+static rlim_t softLimit(int resource) {
+    struct rlimit rl;
+    if (getrlimit(resource, &rl) == -1 || rl.rlim_cur == RLIM_INFINITY) {
+        return 0;
+    }
+    return rl.rlim_cur;
+}
+
+ForkConcurrencyController::ForkConcurrencyController(
+    unsigned processesPerFork,
+    unsigned descriptorsPerFork,
+    unsigned forksPerProcessor) :
+    limit(1),
+    maxLimit(1),
+    successes(0),
+    backoffNanos(minBackoffNanos) {
+    long const numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned const cpus = numCPUs > 0 ? numCPUs : 1;
+
+    maxLimit = forksPerProcessor == 0 ?
+        maxForks : std::min(cpus * forksPerProcessor, maxForks);
+
+    rlim_t const nproc = softLimit(RLIMIT_NPROC);
+    if (nproc != 0) {
+        maxLimit = std::min<rlim_t>(maxLimit, nproc / processesPerFork);
+    }
+
+    rlim_t const nofile = softLimit(RLIMIT_NOFILE);
+    if (nofile != 0 && descriptorsPerFork != 0) {
+        maxLimit = std::min<rlim_t>(
+            maxLimit,
+            nofile > reservedDescriptors ?
+            (nofile - reservedDescriptors) / descriptorsPerFork : 0);
+    }
+
+    maxLimit = std::max(maxLimit, 1u);
+    limit = std::min(cpus, maxLimit);
+}
+
+void ForkConcurrencyController::forkSucceeded() {
+    backoffNanos = minBackoffNanos;
+    // Additive increase: one more slot per limit's worth of successes
+    if (++successes >= limit && limit < maxLimit) {
+        ++limit;
+        successes = 0;
+    }
+}
+
+void ForkConcurrencyController::forkFailed(int error) {
+    switch (error) {
+    default:
+        break;
+    case EAGAIN:
+    case EMFILE:
+    case ENFILE:
+    case ENOMEM:
+        // Multiplicative decrease
+        limit = std::max(limit / 2, 1u);
+        successes = 0;
+        break;
+    }
+}
+
+void ForkConcurrencyController::backoff() {
+    struct timespec delay;
+    delay.tv_sec = 0;
+    delay.tv_nsec = backoffNanos;
+    while (nanosleep(&delay, &delay) == -1 && errno == EINTR) {}
+    backoffNanos = std::min(backoffNanos * 2, maxBackoffNanos);
+}
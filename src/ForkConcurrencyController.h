@@ -0,0 +1,68 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <ctime>
+
+// Decides how many forked explorations may be in flight at once.
+//
+// The initial limit is derived from the process and file descriptor
+// resource limits and the number of online processors. The limit grows by
+// one after as many successful forks in a row as the limit itself, and
+// halves whenever a fork fails for lack of resources (EAGAIN, EMFILE,
+// ENFILE, ENOMEM). When nothing is in flight to free up resources, callers
+// back off for an exponentially growing, sub-millisecond interval before
+// retrying.
+class ForkConcurrencyController {
+public:
+    // Each in-flight exploration uses this many processes and descriptors
+    // (a Fork holds its pipe and, where available, a pidfd; see
+    // forkDescriptors());
+    // explorations that hold no descriptors are not limited by
+    // RLIMIT_NOFILE. At most forksPerProcessor explorations run per online
+    // processor; 0 lifts that cap for explorations that mostly wait on
+    // children of their own, leaving only the resource limits and maxForks
+    ForkConcurrencyController(
+        unsigned processesPerFork = 2,
+        unsigned descriptorsPerFork = 2,
+        unsigned forksPerProcessor = processorOversubscription);
+
+    unsigned getLimit() const { return limit; }
+    unsigned getMaxLimit() const { return maxLimit; }
+
+    bool canDispatch(unsigned inFlight) const { return inFlight < limit; }
+
+    void forkSucceeded();
+
+    // Pass errno from the failed pipe() or fork()
+    void forkFailed(int error);
+
+    // Sleep before retrying a failed fork
+    void backoff();
+
+private:
+    unsigned limit;
+    unsigned maxLimit;
+    unsigned successes;
+    long backoffNanos;
+
+    static unsigned const processorOversubscription = 4;
+    static unsigned const maxForks = 1024;
+    static unsigned const reservedDescriptors = 16;
+    static long const minBackoffNanos = 10000;
+    static long const maxBackoffNanos = 640000;
+};
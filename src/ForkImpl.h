@@ -19,8 +19,6 @@
 #include "Assertions.h"
 #include "SetuidState.h"
 
-#include <boost/iostreams/device/file_descriptor.hpp>
-#include <boost/iostreams/stream.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/map.hpp>
@@ -28,13 +26,13 @@
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
 
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
-namespace ba = boost::archive;
-namespace bios = boost::iostreams;
-
 template <typename Functor>
 FileDescriptor Fork<Functor>::run(typename Functor::Param const& p) {
     if (hasRun) {
@@ -52,24 +50,29 @@ FileDescriptor Fork<Functor>::run(typename Functor::Param const& p) {
     childPID = fork();
 
     if (childPID == -1) {
+        // Callers inspect errno to tell resource exhaustion from other
+        // failures
+        int const forkErrno = errno;
         ASSERT(close(fd[0]) == 0);
         ASSERT(close(fd[1]) == 0);
+        errno = forkErrno;
         return -1;
     }
 
     hasRun = true;
     fdRead = fd[0];
+    if (childPID != 0) {
+        pidFd = openPidDescriptor(childPID);
+    }
 
     if (childPID == 0) {
         // Child
         ASSERT(close(fd[0]) == 0);
-        bios::stream<bios::file_descriptor_sink> fdos(
-            fd[1],
-            bios::close_handle); // TODO: Should close this?
-        {
-            ba::text_oarchive oa(fdos);
-            typename Functor::Rtn const rtn = functor(p);
-            oa << rtn;
+        typename Functor::Rtn const rtn = functor(p);
+        // The parent reads until the frame is complete; anything less means
+        // the child is gone
+        if (!writeFrame(fd[1], archiveToString(rtn))) {
+            exit(1);
         }
         exit(0);
     } else {
@@ -81,32 +84,82 @@ FileDescriptor Fork<Functor>::run(typename Functor::Param const& p) {
 }
 
 template <typename Functor>
-typename Functor::Rtn Fork<Functor>::read() {
+bool Fork<Functor>::tryRead(typename Functor::Rtn& rtn) {
     if (hasRead) {
-        return readValue;
+        rtn = readValue;
+        return true;
     }
-    bios::stream<bios::file_descriptor_source> fdis(
-        fdRead,
-        bios::close_handle); // TODO: Should close this?
-    {
-        ba::text_iarchive ia(fdis);
-        ia >> readValue;
-
-        hasRead = true;
+    ASSERT(hasRun);
+
+    // Grandchildren may hold the pipe open after the child is gone, so also
+    // watch for the child's exit where possible
+    struct pollfd pfds[2];
+    pfds[0].fd = fdRead;
+    pfds[0].events = POLLIN;
+    pfds[1].fd = pidFd;
+    pfds[1].events = POLLIN;
+    nfds_t const numFds = pidFd == -1 || hasReaped ? 1 : 2;
+    long const deadline = monotonicMillis() + timeout;
+
+    for (;;) {
+        pfds[0].revents = pfds[1].revents = 0;
+        int remaining = -1;
+        if (timeout != 0) {
+            long const now = monotonicMillis();
+            remaining = now >= deadline ? 0 : deadline - now;
+        }
+        int const ready = poll(pfds, numFds, remaining);
+        if (ready == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ready == 0) {
+            // Hung; a child that has not been reaped cannot be mistaken for
+            // another process
+            if (!hasReaped) {
+                kill(childPID, SIGKILL);
+            }
+            __sync_fetch_and_add(&forkCounters().timedOut, 1);
+            finish();
+            return false;
+        }
+        if (pfds[0].revents != 0) {
+            break;
+        }
+        if (pfds[1].revents != 0) {
+            // Exited without writing anything
+            finish();
+            return false;
+        }
     }
-    return readValue;
+
+    std::string payload;
+    bool const complete = readFrame(fdRead, payload);
+    finish();
+    if (!complete || !archiveFromString(payload, readValue)) {
+        return false;
+    }
+    hasRead = true;
+    rtn = readValue;
+    return true;
 }
 
+// Close the pipe and reap the child, which is done (or has been killed)
 template <typename Functor>
-int Fork<Functor>::wait() {
-    int rtn;
-    ASSERT(childPID > 0);
-    waitpid(childPID, &rtn, 0);
-    return rtn;
+void Fork<Functor>::finish() {
+    close(fdRead);
+    wait();
 }
 
 template <typename Functor>
-typename Functor::Rtn Fork<Functor>::operator() (typename Functor::Param const& p) {
-    run(p);
-    return read();
+int Fork<Functor>::wait() {
+    ASSERT(childPID > 0);
+    if (!hasReaped) {
+        while (waitpid(childPID, &childStatus, 0) == -1 && errno == EINTR) {}
+        if (pidFd != -1) {
+            close(pidFd);
+        }
+        hasReaped = true;
+        __sync_fetch_and_add(&forkCounters().reaped, 1);
+    }
+    return childStatus;
 }
@@ -0,0 +1,138 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "FailedCallTable.h"
+#include "Graph.h"
+#include "SetuidState.h"
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/compressed_sparse_row_graph.hpp>
+
+// A read-only, compressed-sparse-row copy of a SetuidStateGraph. Exploration
+// is over once a graph has been archived, so everything that only reads a
+// graph (verification, normalization, code generation, CSV output) can run on
+// this instead.
+//
+// Vertex i is the state whose (ruid, euid, svuid) are the digits of i in base
+// |uids| over the sorted UID set; the state -> vertex lookup is arithmetic
+// rather than a map search. That is also the order in which the source graph
+// generated its vertices, so vertex numbers agree between the two. Out-edges
+// of a vertex are stored contiguously, sorted by target (ties keep their
+// original order), so the edges between two states form one contiguous range.
+template<
+    typename EdgeProperty,
+    typename VertexGeneratorType,
+    typename EdgeGeneratorType>
+class FrozenSetuidStateGraph {
+public:
+    typedef SetuidState VertexPropertyType;
+    typedef EdgeProperty EdgePropertyType;
+    typedef VertexGeneratorType VertexGeneratorTypename;
+    typedef EdgeGeneratorType EdgeGeneratorTypename;
+
+    typedef SetuidStateGraph<
+        SetuidState,
+        EdgeProperty,
+        VertexGeneratorType,
+        EdgeGeneratorType> SourceGraph;
+
+    typedef boost::compressed_sparse_row_graph<
+        boost::directedS,
+        SetuidState,
+        EdgeProperty> Graph;
+
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor Vertex;
+    typedef typename boost::graph_traits<Graph>::edge_descriptor Edge;
+    typedef typename Graph::out_edge_iterator EdgeIterator;
+    typedef std::pair<EdgeIterator, EdgeIterator> EdgeIteratorPair;
+    typedef std::vector<Vertex> PredecessorList;
+    typedef int Distance;
+    typedef std::vector<Distance> DistanceList;
+    typedef typename SourceGraph::PathStep PathStep;
+    typedef typename SourceGraph::Path Path;
+    typedef typename SourceGraph::EdgePropertyList EdgePropertyList;
+    typedef std::vector<UID> UIDList;
+
+    explicit FrozenSetuidStateGraph(SourceGraph const& ssg);
+
+    // Same graph, with shortest paths from a different start state
+    FrozenSetuidStateGraph(
+        FrozenSetuidStateGraph const& fg,
+        SetuidState const& _start);
+
+    Path getPath(SetuidState const&) const;
+
+    bool hasVertex(SetuidState const& vp) const;
+    Vertex getVertex(SetuidState const& vp) const;
+    SetuidState const& getState(Vertex v) const { return g[v]; }
+    EdgeIteratorPair const getEdges(
+        SetuidState const& s1,
+        SetuidState const& s2) const;
+
+    // The failed calls at v, as the self-loops they stand for
+    EdgePropertyList getFailedEdges(Vertex v) const {
+        return failures.get(v);
+    }
+
+    SetuidState const& getPredecessor(SetuidState const& v) const;
+
+    // Whether there is a path to v from the start state
+    bool isReachable(Vertex v) const {
+        return dist.at(v) != std::numeric_limits<Distance>::max();
+    }
+
+    SetuidState const& getStart() const { return start; }
+
+    Graph const& getGraph() const { return g; }
+
+    UIDList const& getUIDs() const { return uids; }
+    unsigned getNumVertices() const { return boost::num_vertices(g); }
+
+private:
+    UIDList uids;
+    Graph g;
+    FailedCallTable<EdgeProperty> failures;
+    SetuidState start;
+    PredecessorList pred;
+    DistanceList dist;
+
+    unsigned getDigit(UID uid) const;
+    SetuidState getStateAt(unsigned idx) const;
+    void computeShortestPaths();
+};
+
+template<
+    typename EdgeProperty,
+    typename VertexGeneratorType,
+    typename EdgeGeneratorType>
+FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>
+freeze(SetuidStateGraph<
+           SetuidState,
+           EdgeProperty,
+           VertexGeneratorType,
+           EdgeGeneratorType> const& ssg) {
+    return FrozenSetuidStateGraph<
+        EdgeProperty,
+        VertexGeneratorType,
+        EdgeGeneratorType>(ssg);
+}
+
+#include "FrozenGraphImpl.h"
@@ -0,0 +1,239 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "Assertions.h"
+
+#include <algorithm>
+#include <set>
+
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+
+// Orders (target, edge) pairs by target only, so that a stable sort keeps
+// parallel edges in the order they were added
+template<typename Vertex, typename EdgeProperty>
+struct FrozenEdgeTargetLess {
+    typedef std::pair<Vertex, EdgeProperty const*> FrozenEdge;
+
+    bool operator() (FrozenEdge const& e1, FrozenEdge const& e2) const {
+        return e1.first < e2.first;
+    }
+};
+
+// Compares an out-edge's target against a vertex (in either order), for
+// binary searches over a vertex's target-sorted out-edges
+template<typename Graph>
+struct FrozenEdgeTargetCompare {
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor Vertex;
+    typedef typename boost::graph_traits<Graph>::edge_descriptor Edge;
+
+    FrozenEdgeTargetCompare(Graph const& _g) : g(_g) {}
+
+    bool operator() (Edge const& e, Vertex const& v) const {
+        return boost::target(e, g) < v;
+    }
+    bool operator() (Vertex const& v, Edge const& e) const {
+        return v < boost::target(e, g);
+    }
+
+private:
+    Graph const& g;
+};
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::FrozenSetuidStateGraph(
+    SourceGraph const& ssg) :
+    uids(),
+    g(),
+    failures(),
+    start(ssg.getStart()),
+    pred(),
+    dist() {
+    typedef typename SourceGraph::Graph SourceBoostGraph;
+    typedef typename boost::graph_traits<SourceBoostGraph>::vertex_iterator
+        SourceVertexIterator;
+    typedef FrozenEdgeTargetLess<Vertex, EdgeProperty> TargetLess;
+    typedef typename TargetLess::FrozenEdge FrozenEdge;
+
+    SourceBoostGraph const& sg = ssg.getGraph();
+
+    UIDSet uidSet;
+    SourceVertexIterator vi, ve;
+    for (boost::tie(vi, ve) = boost::vertices(sg); vi != ve; ++vi) {
+        SetuidState const& s = sg[*vi];
+        uidSet.insert(s.ruid);
+        uidSet.insert(s.euid);
+        uidSet.insert(s.svuid);
+    }
+    uids.assign(uidSet.begin(), uidSet.end());
+    unsigned const numUIDs = uids.size();
+    unsigned const numVertices = numUIDs * numUIDs * numUIDs;
+
+    // Gather every edge by source, then lay them out sorted by target
+    std::vector< std::vector<FrozenEdge> > outEdges(numVertices);
+    unsigned numEdges = 0;
+    failures = FailedCallTable<EdgeProperty>(numVertices);
+    for (boost::tie(vi, ve) = boost::vertices(sg); vi != ve; ++vi) {
+        Vertex const v = getVertex(sg[*vi]);
+        EdgePropertyList const failed = ssg.getFailedEdges(*vi);
+        for (typename EdgePropertyList::const_iterator
+                 it = failed.begin(), ie = failed.end(); it != ie; ++it) {
+            failures.add(v, *it);
+        }
+
+        std::vector<FrozenEdge>& out = outEdges.at(v);
+        typename SourceGraph::EdgeIteratorPair edges =
+            boost::out_edges(*vi, sg);
+        for (; edges.first != edges.second; ++edges.first) {
+            out.push_back(FrozenEdge(
+                              getVertex(sg[boost::target(*edges.first, sg)]),
+                              &sg[*edges.first]));
+        }
+        numEdges += out.size();
+    }
+
+    std::vector< std::pair<Vertex, Vertex> > ends;
+    std::vector<EdgeProperty> properties;
+    ends.reserve(numEdges);
+    properties.reserve(numEdges);
+    for (Vertex v = 0; v < numVertices; ++v) {
+        std::vector<FrozenEdge>& out = outEdges.at(v);
+        std::stable_sort(out.begin(), out.end(), TargetLess());
+        for (typename std::vector<FrozenEdge>::const_iterator
+                 it = out.begin(), ie = out.end(); it != ie; ++it) {
+            ends.push_back(std::make_pair(v, it->first));
+            properties.push_back(*it->second);
+        }
+    }
+
+    g = Graph(
+        boost::edges_are_sorted,
+        ends.begin(),
+        ends.end(),
+        properties.begin(),
+        numVertices,
+        numEdges);
+    for (Vertex v = 0; v < numVertices; ++v) {
+        g[v] = getStateAt(v);
+    }
+
+    computeShortestPaths();
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::FrozenSetuidStateGraph(
+    FrozenSetuidStateGraph const& fg,
+    SetuidState const& _start) :
+    uids(fg.uids),
+    g(fg.g),
+    failures(fg.failures),
+    start(_start),
+    pred(),
+    dist() {
+    computeShortestPaths();
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+typename FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::Path
+FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getPath(
+    SetuidState const& sv) const {
+    Path path;
+    Vertex vCurrent = getVertex(sv), vPrevious;
+    for (vPrevious = pred.at(vCurrent);
+         vCurrent != vPrevious;
+         vPrevious = pred.at(vCurrent)) {
+        EdgeIteratorPair edges = getEdges(g[vPrevious], g[vCurrent]);
+        ASSERT(edges.first != edges.second);
+        path.push_front(PathStep(g[*edges.first], g[vCurrent]));
+        vCurrent = vPrevious;
+    }
+    ASSERT(vCurrent == getVertex(start));
+    return path;
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::hasVertex(
+    SetuidState const& vp) const {
+    return (std::binary_search(uids.begin(), uids.end(), vp.ruid) &&
+            std::binary_search(uids.begin(), uids.end(), vp.euid) &&
+            std::binary_search(uids.begin(), uids.end(), vp.svuid));
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+typename FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::Vertex
+FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getVertex(
+    SetuidState const& vp) const {
+    unsigned const numUIDs = uids.size();
+    return ((getDigit(vp.ruid) * numUIDs) + getDigit(vp.euid)) * numUIDs +
+        getDigit(vp.svuid);
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+typename FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::EdgeIteratorPair const
+FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getEdges(
+    SetuidState const& s1,
+    SetuidState const& s2) const {
+    Vertex const v2 = getVertex(s2);
+    EdgeIteratorPair edges = boost::out_edges(getVertex(s1), g);
+    return std::equal_range(
+        edges.first,
+        edges.second,
+        v2,
+        FrozenEdgeTargetCompare<Graph>(g));
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+SetuidState const& FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getPredecessor(
+    SetuidState const& v) const {
+    return g[pred.at(getVertex(v))];
+}
+
+// UID sets are a handful of UIDs, so locating a digit is a few comparisons
+// in a sorted vector
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+unsigned FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getDigit(
+    UID uid) const {
+    typename UIDList::const_iterator it =
+        std::lower_bound(uids.begin(), uids.end(), uid);
+    ASSERT(it != uids.end() && *it == uid);
+    return it - uids.begin();
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+SetuidState FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getStateAt(
+    unsigned idx) const {
+    unsigned const numUIDs = uids.size();
+    UID const svuid = uids.at(idx % numUIDs);
+    idx /= numUIDs;
+    UID const euid = uids.at(idx % numUIDs);
+    idx /= numUIDs;
+    return SetuidState(uids.at(idx), euid, svuid);
+}
+
+template<typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void FrozenSetuidStateGraph<EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::computeShortestPaths() {
+    ASSERT(hasVertex(start));
+    unsigned const numVertices = boost::num_vertices(g);
+    pred = PredecessorList(numVertices);
+    dist = DistanceList(numVertices);
+    boost::dijkstra_shortest_paths(
+        g,
+        getVertex(start),
+        boost::weight_map(get(&EdgeProperty::weight, g)).
+        predecessor_map(boost::make_iterator_property_map(
+                            pred.begin(), get(boost::vertex_index, g))).
+        distance_map(boost::make_iterator_property_map(
+                         dist.begin(), get(boost::vertex_index, g))));
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "GraphVisitor.h"
+#include "ViolationSink.h"
+
+#include <iosfwd>
+
+// A compile-time list of checks (SetuidStateEdgeVisitors and
+// SetuidStateVertexVisitors, each constructible from a Graph const&), e.g.
+//   Checks< AVisitor<Graph>, Checks< BVisitor<Graph> > >
+struct NoChecks {};
+
+template<typename Check, typename Rest = NoChecks>
+struct Checks {};
+
+// One instance of each check in a list
+template<typename Graph, typename CheckList>
+class CheckSet;
+
+template<typename Graph>
+class CheckSet<Graph, NoChecks> {
+public:
+    typedef typename Graph::VertexPropertyType VertexProperty;
+    typedef typename Graph::EdgePropertyType EdgeProperty;
+
+    explicit CheckSet(Graph const&) {}
+
+    void checkVertex(VertexProperty const&, unsigned, ViolationSink&) {}
+    void checkEdge(
+        EdgeProperty const&,
+        VertexProperty const&,
+        VertexProperty const&,
+        unsigned,
+        unsigned,
+        ViolationSink&) {}
+};
+
+template<typename Graph, typename Check, typename Rest>
+class CheckSet< Graph, Checks<Check, Rest> > {
+public:
+    typedef typename Graph::VertexPropertyType VertexProperty;
+    typedef typename Graph::EdgePropertyType EdgeProperty;
+
+    explicit CheckSet(Graph const& g) : check(g), rest(g) {}
+
+    void checkVertex(
+        VertexProperty const& v,
+        unsigned vertex,
+        ViolationSink& sink) {
+        check.checkVertex(v, vertex, sink);
+        rest.checkVertex(v, vertex, sink);
+    }
+    void checkEdge(
+        EdgeProperty const& e,
+        VertexProperty const& v1,
+        VertexProperty const& v2,
+        unsigned vertex,
+        unsigned edge,
+        ViolationSink& sink) {
+        check.checkEdge(e, v1, v2, vertex, edge, sink);
+        rest.checkEdge(e, v1, v2, vertex, edge, sink);
+    }
+
+private:
+    Check check;
+    CheckSet<Graph, Rest> rest;
+};
+
+// Runs every check in CheckList over a FrozenSetuidStateGraph in one pass:
+// each state reachable from the start state is checked, then each call made
+// from it, reading the graph's vertex and edge arrays in order. These are the
+// states and edges one breadth-first search per check would visit.
+//
+// Violations are recorded against the vertex index and, for calls, an edge
+// number: the vertex's out-edges in order, then its failed calls (see
+// FusedVerifierDescriber).
+//
+// Built with MULTITHREADED, states are handed out in blocks to one thread per
+// online processor, each with its own instance of every check and its own
+// sink; the sinks are merged at the end.
+template<typename Graph, typename CheckList>
+class FusedVerifier {
+public:
+    explicit FusedVerifier(Graph const& _g) : g(_g) {}
+
+    void verify(ViolationSink& sink) const;
+
+private:
+    typedef typename Graph::Vertex Vertex;
+
+    // States a thread takes at a time
+    static unsigned const blockSize = 64;
+
+    struct Sweep {
+        Sweep(Graph const& _g) : g(_g), nextSource(0) {}
+
+        Graph const& g;
+        // First state of the next block, shared by all threads
+        unsigned nextSource;
+    };
+
+    struct Worker {
+        Worker(Sweep& _sweep) : sweep(_sweep), sink() {}
+
+        Sweep& sweep;
+        ViolationSink sink;
+    };
+
+    Graph const& g;
+
+    static void checkStates(Sweep& sweep, ViolationSink& sink);
+    static void* checkStates(void* worker);
+};
+
+// Describes violations recorded by a FusedVerifier
+template<typename Graph>
+class FusedVerifierDescriber : public ViolationDescriber {
+public:
+    explicit FusedVerifierDescriber(Graph const& _g) : g(_g) {}
+
+    void describe(std::ostream& os, unsigned vertex, unsigned edge) const;
+
+private:
+    Graph const& g;
+};
+
+#include "FusedVerifierImpl.h"
@@ -0,0 +1,133 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+#ifdef MULTITHREADED
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+template<typename Graph, typename CheckList>
+void FusedVerifier<Graph, CheckList>::verify(ViolationSink& sink) const {
+    Sweep sweep(g);
+
+#ifdef MULTITHREADED
+    long const numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned const numThreads = numCPUs > 1 ? numCPUs - 1 : 0;
+    std::vector<Worker*> workers;
+    std::vector<pthread_t> threads;
+    for (unsigned i = 0; i < numThreads; ++i) {
+        Worker* worker = new Worker(sweep);
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, checkStates, worker) != 0) {
+            delete worker;
+            break;
+        }
+        workers.push_back(worker);
+        threads.push_back(thread);
+    }
+    // This thread takes blocks too, so the work gets done even if no thread
+    // could be started
+    checkStates(sweep, sink);
+    for (unsigned i = 0; i < threads.size(); ++i) {
+        pthread_join(threads[i], NULL);
+        sink.merge(workers[i]->sink);
+        delete workers[i];
+    }
+#else
+    checkStates(sweep, sink);
+#endif
+}
+
+template<typename Graph, typename CheckList>
+void FusedVerifier<Graph, CheckList>::checkStates(
+    Sweep& sweep,
+    ViolationSink& sink) {
+    typedef typename Graph::Graph BoostGraph;
+    typedef typename Graph::EdgePropertyList EdgePropertyList;
+
+    Graph const& g = sweep.g;
+    BoostGraph const& boostGraph = g.getGraph();
+    unsigned const numVertices = g.getNumVertices();
+    CheckSet<Graph, CheckList> checks(g);
+    for (unsigned first = __sync_fetch_and_add(&sweep.nextSource, blockSize);
+         first < numVertices;
+         first = __sync_fetch_and_add(&sweep.nextSource, blockSize)) {
+        unsigned const last = std::min(first + blockSize, numVertices);
+        for (Vertex v = first; v < last; ++v) {
+            if (!g.isReachable(v)) {
+                continue;
+            }
+            typename Graph::VertexPropertyType const& s = boostGraph[v];
+            checks.checkVertex(s, v, sink);
+            unsigned edge = 0;
+            typename Graph::EdgeIteratorPair edges =
+                boost::out_edges(v, boostGraph);
+            for (; edges.first != edges.second; ++edges.first, ++edge) {
+                checks.checkEdge(
+                    boostGraph[*edges.first],
+                    s,
+                    boostGraph[boost::target(*edges.first, boostGraph)],
+                    v,
+                    edge,
+                    sink);
+            }
+            EdgePropertyList const failed = g.getFailedEdges(v);
+            for (typename EdgePropertyList::const_iterator
+                     it = failed.begin(), ie = failed.end();
+                 it != ie; ++it, ++edge) {
+                checks.checkEdge(*it, s, s, v, edge, sink);
+            }
+        }
+    }
+}
+
+template<typename Graph, typename CheckList>
+void* FusedVerifier<Graph, CheckList>::checkStates(void* worker) {
+    Worker* const w = static_cast<Worker*>(worker);
+    checkStates(w->sweep, w->sink);
+    return NULL;
+}
+
+template<typename Graph>
+void FusedVerifierDescriber<Graph>::describe(
+    std::ostream& os,
+    unsigned vertex,
+    unsigned edge) const {
+    typename Graph::Graph const& boostGraph = g.getGraph();
+    typename Graph::Vertex const v = vertex;
+    typename Graph::VertexPropertyType const& s = boostGraph[v];
+    if (edge == ViolationSink::noEdge) {
+        os << s;
+        return;
+    }
+    typename Graph::EdgeIteratorPair const edges =
+        boost::out_edges(v, boostGraph);
+    unsigned const numEdges = edges.second - edges.first;
+    if (edge < numEdges) {
+        typename Graph::EdgeIterator const it = edges.first + edge;
+        os << boostGraph[*it] << " " << s << " -> "
+           << boostGraph[boost::target(*it, boostGraph)];
+    } else {
+        os << g.getFailedEdges(v).at(edge - numEdges) << " " << s
+           << " -> " << s;
+    }
+}
@@ -16,6 +16,7 @@
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
+#include "FailedCallTable.h"
 #include "SetuidState.h"
 
 #include <map>
@@ -24,6 +25,7 @@
 #include <vector>
 
 #include <boost/graph/adjacency_list.hpp>
+#include <boost/serialization/version.hpp>
 
 namespace boost { namespace serialization { class access; } }
 
@@ -134,6 +136,8 @@ public:
     typedef std::vector<Vertex> PredecessorList;
     typedef int Distance;
     typedef std::vector<Distance> DistanceList;
+    typedef typename FailedCallTable<EdgeProperty>::EdgePropertyList
+        EdgePropertyList;
 
     struct PathStep {
         friend class boost::serialization::access;
@@ -161,7 +165,7 @@ public:
     typedef std::list<PathStep> Path;
     typedef std::map<VertexProperty, Vertex> VertexPropertyMap;
 
-    SetuidStateGraph() {}
+    SetuidStateGraph() : bulkInsert(false), shortestPathsDirty(false) {}
 
     SetuidStateGraph(
         VertexGeneratorType const& generator,
@@ -171,16 +175,32 @@ public:
     SetuidStateGraph(SetuidStateGraph const& ssg, VertexProperty const& _start);
 
     Path getPath(VertexProperty const&) const;
+
+    // Failed calls (self-loops that leave the state unchanged) are not stored
+    // as edges of the boost graph; see getFailedEdges()
     void addEdge(
         VertexProperty const& v1,
         VertexProperty const& v2,
         EdgeProperty const& e);
 
+    // Bulk-insert mode: while enabled, addEdge() only marks shortest-path data
+    // as stale; it is recomputed once, on demand, by the next query
+    void beginBulkInsert() { bulkInsert = true; }
+    void endBulkInsert() { bulkInsert = false; }
+
+    bool hasVertex(VertexProperty const& vp) const {
+        return vPropMap.find(vp) != vPropMap.end();
+    }
     Vertex const& getVertex(VertexProperty const& vp) const;
     EdgeIteratorPair const getEdges(
         VertexProperty const& s1,
         VertexProperty const& s2) const;
 
+    // The failed calls at v, as the self-loops they stand for
+    EdgePropertyList getFailedEdges(Vertex const& v) const {
+        return failures.get(get(boost::vertex_index, g, v));
+    }
+
     VertexProperty const& getPredecessor(VertexProperty const& v) const;
 
     VertexProperty const& getStart() const { return start; }
@@ -189,21 +209,60 @@ public:
 
 private:
     Graph g;
+    FailedCallTable<EdgeProperty> failures;
     VertexProperty start;
     VertexPropertyMap vPropMap;
-    PredecessorList pred;
-    DistanceList dist;
-
-    void computeShortestPaths();
-
+    // Shortest-path data is a cache over g; it may be stale while
+    // shortestPathsDirty is set
+    mutable PredecessorList pred;
+    mutable DistanceList dist;
+    bool bulkInsert;
+    mutable bool shortestPathsDirty;
+
+    void computeShortestPaths() const;
+    void ensureShortestPaths() const;
+    void relaxShortestPaths(Vertex const& v1, Vertex const& v2);
+    void separateFailedEdges();
+
+    // Version 0 archives stored failed calls as self-loops in g
     template<class Archive>
     void serialize(Archive& ar, unsigned int const version) {
+        if (Archive::is_saving::value) {
+            ensureShortestPaths();
+        }
         ar & g;
         ar & start;
         ar & pred;
         ar & dist;
         ar & vPropMap;
+        if (version > 0) {
+            ar & failures;
+        }
+        if (Archive::is_loading::value) {
+            if (version == 0) {
+                separateFailedEdges();
+            }
+            bulkInsert = false;
+            shortestPathsDirty = false;
+        }
     }
 };
 
+namespace boost { namespace serialization {
+template<
+    typename VertexProperty,
+    typename EdgeProperty,
+    typename VertexGeneratorType,
+    typename EdgeGeneratorType>
+struct version< SetuidStateGraph<
+                    VertexProperty,
+                    EdgeProperty,
+                    VertexGeneratorType,
+                    EdgeGeneratorType> > {
+    typedef mpl::int_<1> type;
+    typedef mpl::integral_c_tag tag;
+    BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+} }
+
 #include "GraphImpl.h"
@@ -16,11 +16,22 @@
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
+#include "ExploreWorkerPool.h"
 #include "Fork.h"
+#include "ForkConcurrencyController.h"
 #include "Graph.h"
+#include "ResultArena.h"
 
+#include <sys/types.h>
+
+#include <ctime>
+#include <deque>
+#include <map>
+#include <ostream>
 #include <set>
 #include <queue>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace boost { namespace serialization { class access; } }
@@ -68,6 +79,12 @@ class GraphExplorer {
         VertexGeneratorType,
         EdgeGeneratorType>;
 
+    friend class ExploreWorkerPool<
+        VertexProperty,
+        EdgeProperty,
+        VertexGeneratorType,
+        EdgeGeneratorType>;
+
 public:
     typedef SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType> Graph;
     typedef typename Graph::PathStep PathStep;
@@ -78,7 +95,12 @@ public:
     typedef Fork<ExploreCallType> ForkExploreCall;
     typedef Fork<ExploreStateType> ForkExploreState;
     typedef std::vector<ForkExploreCall> ForkExploreCalls;
-    typedef std::vector<ForkExploreState> ForkExploreStates;
+    // In-flight state explorations, keyed by the pipe each one reports on
+    typedef std::map<FileDescriptor, std::pair<VertexProperty, ForkExploreState> > ForkExploreStates;
+    // In-flight state explorations, keyed by the arena slot each one
+    // reports in
+    typedef std::map<unsigned, std::pair<VertexProperty, pid_t> > SharedExploreStates;
+    typedef ExploreWorkerPool<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType> WorkerPool;
 
     GraphExplorer(
         Graph _g,
@@ -87,29 +109,221 @@ public:
         typename EdgeGeneratorType::EdgeInputCollection const& genInput2) :
         g(_g),
         edges(edgeGenerator.generateAll(genInput1, genInput2)),
-        numStateForks(0) {}
+        forkController(2, forkDescriptors()),
+        lastReport(0),
+        workerPoolSize(0),
+        forkTree(false),
+        sharedResults(false),
+        probeTimeout(0),
+        checkpointPath(),
+        checkpointInterval(0),
+        lastCheckpoint(0),
+        seeded(false),
+        seedVisited(),
+        seedPending() {}
 
     virtual ~GraphExplorer() {}
 
     virtual void exploreAll();
 
+    // Explore with a pool of this many persistent workers instead of forking
+    // per state and per call; zero selects the fork-per-call explorer
+    void setWorkerPoolSize(unsigned size) { workerPoolSize = size; }
+
+    // Explore depth-first from nested forks: a process that lands in a state
+    // nobody has claimed yet makes every call from that state in children of
+    // its own, so no path prefix is ever replayed. Takes precedence over the
+    // worker pool; cannot be combined with reductions, seeding or
+    // checkpoints
+    void setForkTree(bool enabled) { forkTree = enabled; }
+
+    // Have each forked state exploration report into a slot of a shared
+    // memory arena rather than over a pipe of its own, so the number in
+    // flight is no longer bounded by descriptor limits. Applies to the
+    // fork-per-state explorer (a worker pool size of zero)
+    void setSharedResults(bool enabled);
+
+    // Kill and retry a forked call exploration that has not reported after
+    // this many milliseconds; 0 waits forever
+    void setProbeTimeout(unsigned millis) { probeTimeout = millis; }
+
+    // Save the graph and frontier to path every interval seconds so that an
+    // interrupted exploration can be seeded; the checkpoint is removed once
+    // exploration completes
+    void setCheckpoint(std::string const& path, unsigned interval);
+
+    // Continue from the checkpoint at path instead of the start state. Calls
+    // already made from a state are not made again. Returns false if there
+    // is no usable checkpoint
+    bool resumeFromCheckpoint(std::string const& path);
+
+    // Start from the edges of an earlier exploration over a subset of this
+    // explorer's UIDs and calls, probing only the (state, call) pairs it is
+    // missing. Returns false if previous does not fit in this graph
+    bool seedFromGraph(Graph const& previous);
+
     Graph const& getGraph() const { return g; }
 
+    // Calls given up on after their probes kept failing; the graph lacks
+    // their edges
+    unsigned long getGivenUp() const { return forkCounters().givenUp; }
+
 protected:
     Graph g;
     typename EdgeGeneratorType::OutputCollection edges;
 
     // Fork management
-    unsigned numStateForks;
-    static unsigned const forkFailureThreshold = 1;
-    static unsigned const stateForkLimit = 25;
-    static unsigned const failureSleepTime = 1;
+    ForkConcurrencyController forkController;
+    // Seconds between progress reports
+    static unsigned const reportInterval = 10;
+    time_t lastReport;
+
+    // Worker pool management
+    unsigned workerPoolSize;
+    bool forkTree;
+    bool sharedResults;
+    // Milliseconds between checks on children that have not reported
+    static int const sharedReapInterval = 100;
+    unsigned probeTimeout;
+    // Attempts at a call beyond the first before it is given up on
+    static unsigned const probeRetries = 2;
+
+    void exploreAllPooled();
+
+    // Explore without forking, for explorers whose calls do not touch the
+    // explorer's own process (see exploresInProcess())
+    void exploreAllInProcess();
+
+    void exploreAllForkTree();
+
+    void exploreAllShared();
+
+    unsigned dispatchSharedStates(
+        std::queue<VertexProperty>& vertexQueue,
+        ResultArena& arena,
+        SharedExploreStates& sharedStates,
+        std::vector<unsigned>& freeSlots);
+
+    // Wait for a child to report (or die), then consume every finished
+    // state; states whose child died without a result are queued again
+    void collectSharedStates(
+        std::set<VertexProperty>& vertexSet,
+        std::queue<VertexProperty>& vertexQueue,
+        ResultArena& arena,
+        SharedExploreStates& sharedStates,
+        std::vector<unsigned>& freeSlots);
+
+    // Explore state in a child that reports over a pipe, for results too
+    // large for an arena slot; false if the child ended without a result
+    bool exploreStateOverPipe(
+        VertexProperty const& state,
+        typename ExploreStateType::Rtn& edgeSet);
+
+    // Make every call from state (the current state) in a child; children
+    // that claim the state they land in explore it in turn. Edges are
+    // reported on results. A process always may have one child in flight;
+    // siblings beyond the first are counted in extraForks, which the fork
+    // controller limits across the whole tree
+    void exploreSubtree(
+        VertexProperty const& state,
+        unsigned char* claims,
+        unsigned* extraForks,
+        FileDescriptor results);
+
+    // Reap one child of exploreSubtree(), releasing its slot if it held one
+    void reapSubtreeChild(
+        VertexProperty const& state,
+        std::map<pid_t, bool>& children,
+        unsigned* extraForks);
+
+    void enqueueCalls(
+        VertexProperty const& v,
+        std::deque<typename WorkerPool::Job>& jobQueue,
+        unsigned& nextJobId);
+
+    // Checkpoint management
+    std::string checkpointPath;
+    unsigned checkpointInterval;
+    time_t lastCheckpoint;
+    // Set when the graph starts out partially explored (by a checkpoint or
+    // an earlier exploration); calls already made from a state are skipped
+    bool seeded;
+    std::set<VertexProperty> seedVisited;
+    std::vector<VertexProperty> seedPending;
+
+    // Start the progress clock; returns the states to explore first (those
+    // of the seed, or the start state), having added the states found so far
+    // to vertexSet
+    std::vector<VertexProperty> beginExploration(
+        std::set<VertexProperty>& vertexSet);
+
+    // Run finishExploration() and remove the checkpoint
+    void endExploration();
+
+    // Report progress if a report is due; a limit of 0 reports nothing in
+    // flight
+    void reportProgress(
+        size_t found,
+        size_t queued,
+        size_t inFlight,
+        unsigned limit);
+
+    // Checkpoint if one is due. States are only complete once nothing
+    // queued or in flight is exploring them
+    void checkpointIfDue(
+        std::set<VertexProperty> const& vertexSet,
+        std::queue<VertexProperty> const& queued);
+
+    template<typename Queued, typename InFlight>
+    void checkpointIfDue(
+        std::set<VertexProperty> const& vertexSet,
+        Queued const& queued,
+        InFlight const& inFlight);
+
+    static void addPending(
+        std::queue<VertexProperty> const& queued,
+        std::set<VertexProperty>& pending);
+    static void addPending(
+        ForkExploreStates const& inFlight,
+        std::set<VertexProperty>& pending);
+    static void addPending(
+        SharedExploreStates const& inFlight,
+        std::set<VertexProperty>& pending);
+    static void addPending(
+        std::deque<typename WorkerPool::Job> const& queued,
+        std::set<VertexProperty>& pending);
+    static void addPending(
+        std::map<unsigned, typename WorkerPool::Job> const& inFlight,
+        std::set<VertexProperty>& pending);
+
+    bool checkpointDue(time_t now) const;
+
+    void writeCheckpoint(
+        std::set<VertexProperty> const& visited,
+        std::set<VertexProperty> const& pending);
+
+    // Calls that already have an edge out of v
+    typename EdgeGeneratorType::OutputCollection exploredCalls(
+        VertexProperty const& v) const;
+
+    // Block until at least one in-flight state finishes; consume every
+    // finished state, dispatching new states as slots free up
+    void collectForkStates(
+        std::set<VertexProperty>& vertexSet,
+        std::queue<VertexProperty>& vertexQueue,
+        ForkExploreStates& forkStates);
 
-    void bufferForkStates(
+    void readForkState(
+        typename ForkExploreStates::iterator forkState,
         std::set<VertexProperty>& vertexSet,
         std::queue<VertexProperty>& vertexQueue,
-        ForkExploreStates& readBuffer,
-        ForkExploreStates& writeBuffer);
+        ForkExploreStates& forkStates);
+
+    // Add the edges found from a state, queueing newly discovered states
+    void recordEdges(
+        typename ExploreStateType::Rtn const& edgeSet,
+        std::set<VertexProperty>& vertexSet,
+        std::queue<VertexProperty>& vertexQueue);
 
     unsigned dispatchForkStates(
         std::queue<VertexProperty>& vertexQueue,
@@ -121,7 +335,54 @@ protected:
 
     void followPath(Path const& path);
 
+    // Make call from state in a child, retrying children that hang or die;
+    // false if every attempt failed
+    virtual bool probeCall(
+        VertexProperty const& state,
+        typename EdgeGeneratorType::OutputItem const& call,
+        PathStep& step);
+
     virtual EdgeProperty exploreEdge(typename EdgeGeneratorType::OutputItem const&) = 0;
+
+    // Explorers that make calls on a model rather than on the process itself
+    // explore in process; currentVertex() is where the last call left off
+    virtual bool exploresInProcess() const { return false; }
+
+    virtual VertexProperty currentVertex() const { return VertexProperty::get(); }
+
+    // Conservative: may making this call from this state leave a process
+    // unable to jump back to where it started? Pool workers make calls that
+    // cannot lose privilege themselves, and fork for the rest
+    virtual bool mayLosePrivilege(
+        VertexProperty const&,
+        typename EdgeGeneratorType::OutputItem const&) const { return true; }
+
+    // Reduction hooks; by default every state and call is explored.
+    // discoverVertex() is told of each edge found and returns the state to
+    // explore on behalf of its target. Only calls accepted by
+    // shouldExploreCall() are made from a state. getPathTo() gives a path
+    // from the start state to a state that is to be explored, and
+    // finishExploration() may rewrite the graph once exploration is done
+    virtual VertexProperty discoverVertex(
+        VertexProperty const& from,
+        EdgeProperty const& edge,
+        VertexProperty const& to) { return to; }
+
+    virtual bool shouldExploreCall(
+        VertexProperty const&,
+        typename EdgeGeneratorType::OutputItem const&) const { return true; }
+
+    virtual Path getPathTo(VertexProperty const& v) const { return g.getPath(v); }
+
+    // Edges known without being probed, given the outcome of making call
+    // from v: the edges of calls that shouldExploreCall() passed over
+    virtual void impliedEdges(
+        VertexProperty const& v,
+        typename EdgeGeneratorType::OutputItem const& call,
+        PathStep const& outcome,
+        std::vector<PathStep>& implied) const {}
+
+    virtual void finishExploration() {}
 };
 
 template<
@@ -237,6 +498,10 @@ public:
         Param(VertexProperty const& _v, Priv2Call const& _call) :
             vertex(_v), call(_call) {}
 
+        friend std::ostream& operator<<(std::ostream& os, Param const& p) {
+            return os << p.call << " from " << p.vertex;
+        }
+
         VertexProperty const& vertex;
         Priv2Call const& call;
 
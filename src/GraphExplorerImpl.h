@@ -16,75 +16,938 @@
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
+#include "CloneProbe.h"
+#include "CredentialModel.h"
 #include "Graph.h"
 #include "Platform.h"
 // #include "Priv2State.h"
 #include "PrivWrapper.h"
 #include "SetuidState.h"
+#include "SymmetryReduction.h"
+#include "Util.h"
 
 #include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #include <cstring>
+#include <ctime>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <queue>
 #include <set>
+#include <sstream>
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/graph/adj_list_serialize.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
 
 template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
 void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploreAll() {
+    if (exploresInProcess()) {
+        exploreAllInProcess();
+        return;
+    }
+    // Counters must be shared before the first fork
+    forkCounters();
+
+    if (forkTree) {
+        exploreAllForkTree();
+        return;
+    }
+    if (workerPoolSize > 0) {
+        exploreAllPooled();
+        return;
+    }
+    if (sharedResults) {
+        exploreAllShared();
+        return;
+    }
+
     std::set<VertexProperty> vertexSet;
     std::queue<VertexProperty> vertexQueue;
+    ForkExploreStates forkStates;
 
-    vertexSet.insert(g.getStart());
-    vertexQueue.push(g.getStart());
+    std::vector<VertexProperty> const initial = beginExploration(vertexSet);
+    for (typename std::vector<VertexProperty>::const_iterator
+             it = initial.begin(), ie = initial.end(); it != ie; ++it) {
+        vertexQueue.push(*it);
+    }
+
+    // Exhaust all found states, consuming results in completion order
+    while (!vertexQueue.empty() || !forkStates.empty()) {
+        dispatchForkStates(vertexQueue, forkStates);
+        if (!forkStates.empty()) {
+            collectForkStates(vertexSet, vertexQueue, forkStates);
+        }
 
-    // Exhaust all found states
-    ForkExploreStates forkStates1, forkStates2;
-    dispatchForkStates(vertexQueue, forkStates1);
-    while (!vertexQueue.empty() ||    // More states ready to dispatch OR
-           forkStates1.size() != 0 || // More states ready to read (1) OR
-           forkStates2.size() != 0) { // More states ready to read (2)
-        // Read from states dispatched to 1, dispatch new states to 2
-        bufferForkStates(vertexSet, vertexQueue, forkStates1, forkStates2);
-        // All states form 1 read; clear it out
-        forkStates1 = ForkExploreStates();
-        // Read from states dispatched to 2, dispatch new states to 1
-        bufferForkStates(vertexSet, vertexQueue, forkStates2, forkStates1);
-        // All states form 2 read; clear it out
-        forkStates2 = ForkExploreStates();
+        reportProgress(
+            vertexSet.size(),
+            vertexQueue.size(),
+            forkStates.size(),
+            forkController.getLimit());
+        checkpointIfDue(vertexSet, vertexQueue, forkStates);
     }
+
+    std::cerr << "Explorer: forks: " << forkCounters() << std::endl;
+    endExploration();
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::setSharedResults(
+    bool enabled) {
+    sharedResults = enabled;
+    // Children reporting in the arena hold no descriptors in the parent,
+    // and spend most of their time waiting on their own probes, so neither
+    // RLIMIT_NOFILE nor the processor count caps how many are in flight
+    forkController = enabled ?
+        ForkConcurrencyController(2, 0, 0) :
+        ForkConcurrencyController(2, forkDescriptors());
 }
 
 template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
-void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::bufferForkStates(
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploreAllShared() {
+    typedef typename ExploreStateType::Edge Edge;
+
+    // Room for an edge per call (and then some); larger results fall back
+    // to a pipe
+    size_t const slotCapacity = sizeof(WireCount) +
+        2 * edges.size() * archiveToString(Edge()).size();
+    ResultArena arena;
+    if (!arena.create(forkController.getMaxLimit(), slotCapacity)) {
+        std::cerr << "Explorer: cannot map result arena ("
+                  << std::strerror(errno) << "); reporting over pipes"
+                  << std::endl;
+        setSharedResults(false);
+        exploreAll();
+        return;
+    }
+
+    std::set<VertexProperty> vertexSet;
+    std::queue<VertexProperty> vertexQueue;
+    SharedExploreStates sharedStates;
+    std::vector<unsigned> freeSlots;
+    for (unsigned i = arena.getNumSlots(); i > 0; --i) {
+        freeSlots.push_back(i - 1);
+    }
+
+    std::vector<VertexProperty> const initial = beginExploration(vertexSet);
+    for (typename std::vector<VertexProperty>::const_iterator
+             it = initial.begin(), ie = initial.end(); it != ie; ++it) {
+        vertexQueue.push(*it);
+    }
+
+    while (!vertexQueue.empty() || !sharedStates.empty()) {
+        dispatchSharedStates(vertexQueue, arena, sharedStates, freeSlots);
+        if (!sharedStates.empty()) {
+            collectSharedStates(
+                vertexSet, vertexQueue, arena, sharedStates, freeSlots);
+        }
+
+        reportProgress(
+            vertexSet.size(),
+            vertexQueue.size(),
+            sharedStates.size(),
+            forkController.getLimit());
+        checkpointIfDue(vertexSet, vertexQueue, sharedStates);
+    }
+
+    std::cerr << "Explorer: forks: " << forkCounters() << std::endl;
+    endExploration();
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+unsigned GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::dispatchSharedStates(
+    std::queue<VertexProperty>& vertexQueue,
+    ResultArena& arena,
+    SharedExploreStates& sharedStates,
+    std::vector<unsigned>& freeSlots) {
+    unsigned newlyDispatched = 0;
+    while (!vertexQueue.empty() && !freeSlots.empty() &&
+           forkController.canDispatch(sharedStates.size())) {
+        VertexProperty const state = vertexQueue.front();
+        unsigned const slot = freeSlots.back();
+
+        pid_t const pid = fork();
+        if (pid == 0) {
+            typename ExploreStateType::Rtn const rtn =
+                ExploreStateType(*this)(state);
+            arena.publish(slot, archiveToString(rtn));
+            exit(0);
+        } else if (pid == -1) {
+            forkController.forkFailed(errno);
+            if (!sharedStates.empty()) {
+                break;
+            }
+            forkController.backoff();
+            continue;
+        }
+
+        freeSlots.pop_back();
+        vertexQueue.pop();
+        sharedStates.insert(std::make_pair(slot, std::make_pair(state, pid)));
+        forkController.forkSucceeded();
+        ++newlyDispatched;
+    }
+    return newlyDispatched;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::collectSharedStates(
     std::set<VertexProperty>& vertexSet,
     std::queue<VertexProperty>& vertexQueue,
-    ForkExploreStates& readBuffer,
-    ForkExploreStates& writeBuffer) {
-    // Read from existing forked states from readBuffer
-    for (typename ForkExploreStates::iterator fesIt = readBuffer.begin(),
-             fesIe = readBuffer.end(); fesIt != fesIe; ++fesIt) {
-
-        typename ExploreStateType::Rtn edgeSet = fesIt->read();
-        --numStateForks;
-
-        // Construct each edge found
-        for (typename ExploreStateType::Rtn::const_iterator
-                 esrIt = edgeSet.begin(), esrIe = edgeSet.end();
-             esrIt != esrIe; ++esrIt) {
-            VertexProperty const& v1 = esrIt->vertex;
-            EdgeProperty const& e = esrIt->pathStep.edge;
-            VertexProperty const& v2 = esrIt->pathStep.nextVertex;
+    ResultArena& arena,
+    SharedExploreStates& sharedStates,
+    std::vector<unsigned>& freeSlots) {
+    // Children that die before publishing never notify, so wake up now and
+    // then to look for them
+    struct pollfd pfd;
+    pfd.fd = arena.getNotifier();
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    poll(&pfd, 1, sharedReapInterval);
+    arena.drain();
+
+    typename SharedExploreStates::iterator it = sharedStates.begin();
+    while (it != sharedStates.end()) {
+        unsigned const slot = it->first;
+        VertexProperty const state = it->second.first;
+        pid_t const pid = it->second.second;
+
+        ResultArena::SlotStatus status = arena.getStatus(slot);
+        if (status == ResultArena::SlotPending) {
+            pid_t const reaped = waitpid(pid, NULL, WNOHANG);
+            if (reaped == 0 || (reaped == -1 && errno == EINTR)) {
+                ++it;
+                continue;
+            }
+            __sync_fetch_and_add(&forkCounters().reaped, 1);
+            // The child may have published just before exiting
+            status = arena.getStatus(slot);
+        } else {
+            while (waitpid(pid, NULL, 0) == -1 && errno == EINTR) {}
+            __sync_fetch_and_add(&forkCounters().reaped, 1);
+        }
+
+        typename ExploreStateType::Rtn edgeSet;
+        bool found = false;
+        switch (status) {
+        case ResultArena::SlotPending:
+            break;
+        case ResultArena::SlotComplete:
+            found = archiveFromString(arena.read(slot), edgeSet);
+            break;
+        case ResultArena::SlotOverflow:
+            found = exploreStateOverPipe(state, edgeSet);
+            break;
+        }
+
+        arena.clear(slot);
+        freeSlots.push_back(slot);
+        sharedStates.erase(it++);
+        if (found) {
+            recordEdges(edgeSet, vertexSet, vertexQueue);
+        } else {
+            std::cerr << "Explorer: exploration of " << state
+                      << " ended without a result; retrying" << std::endl;
+            __sync_fetch_and_add(&forkCounters().retried, 1);
+            vertexQueue.push(state);
+        }
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploreStateOverPipe(
+    VertexProperty const& state,
+    typename ExploreStateType::Rtn& edgeSet) {
+    ForkExploreState forkState = ForkExploreState(ExploreStateType(*this));
+    while (forkState.run(state) == -1) {
+        forkController.forkFailed(errno);
+        forkController.backoff();
+    }
+    return forkState.tryRead(edgeSet);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::setCheckpoint(
+    std::string const& path, unsigned interval) {
+    checkpointPath = path;
+    checkpointInterval = interval;
+    lastCheckpoint = time(NULL);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::resumeFromCheckpoint(
+    std::string const& path) {
+    std::string contents;
+    if (!readFile(path, contents)) {
+        return false;
+    }
+
+    Graph checkpointGraph;
+    std::set<VertexProperty> visited;
+    std::vector<VertexProperty> pending;
+    try {
+        std::istringstream iss(contents);
+        boost::archive::text_iarchive ia(iss);
+        ia >> checkpointGraph;
+        ia >> visited;
+        ia >> pending;
+    } catch (...) {
+        return false;
+    }
+
+    // A checkpoint only applies to an exploration from the same state
+    if (!(checkpointGraph.getStart() == g.getStart())) {
+        return false;
+    }
+
+    g = checkpointGraph;
+    seedVisited = visited;
+    seedPending = pending;
+    seeded = true;
+    return true;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::seedFromGraph(
+    Graph const& previous) {
+    if (!(previous.getStart() == g.getStart())) {
+        return false;
+    }
+
+    typedef typename Graph::Graph BoostGraph;
+    BoostGraph const& pg = previous.getGraph();
+
+    // Every state reached before has to be re-explored with the new calls
+    std::set<VertexProperty> visited;
+    visited.insert(previous.getStart());
+    typename boost::graph_traits<BoostGraph>::edge_iterator eIt, eIe;
+    for (boost::tie(eIt, eIe) = boost::edges(pg); eIt != eIe; ++eIt) {
+        VertexProperty const& v1 = pg[boost::source(*eIt, pg)];
+        VertexProperty const& v2 = pg[boost::target(*eIt, pg)];
+        if (!g.hasVertex(v1) || !g.hasVertex(v2)) {
+            return false;
+        }
+        visited.insert(v1);
+        visited.insert(v2);
+    }
+    typename boost::graph_traits<BoostGraph>::vertex_iterator vIt, vIe;
+    for (boost::tie(vIt, vIe) = boost::vertices(pg); vIt != vIe; ++vIt) {
+        if (previous.getFailedEdges(*vIt).empty()) {
+            continue;
+        }
+        if (!g.hasVertex(pg[*vIt])) {
+            return false;
+        }
+        visited.insert(pg[*vIt]);
+    }
+
+    g.beginBulkInsert();
+    for (boost::tie(eIt, eIe) = boost::edges(pg); eIt != eIe; ++eIt) {
+        g.addEdge(
+            pg[boost::source(*eIt, pg)],
+            pg[boost::target(*eIt, pg)],
+            pg[*eIt]);
+    }
+    for (boost::tie(vIt, vIe) = boost::vertices(pg); vIt != vIe; ++vIt) {
+        typename Graph::EdgePropertyList const failed =
+            previous.getFailedEdges(*vIt);
+        for (typename Graph::EdgePropertyList::const_iterator
+                 it = failed.begin(), ie = failed.end(); it != ie; ++it) {
+            g.addEdge(pg[*vIt], pg[*vIt], *it);
+        }
+    }
+    g.endBulkInsert();
+
+    seedVisited = visited;
+    seedPending = std::vector<VertexProperty>(visited.begin(), visited.end());
+    seeded = true;
+    return true;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+std::vector<VertexProperty> GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::beginExploration(
+    std::set<VertexProperty>& vertexSet) {
+    lastReport = time(NULL);
+    if (seeded) {
+        vertexSet = seedVisited;
+        return seedPending;
+    }
+    vertexSet.insert(g.getStart());
+    return std::vector<VertexProperty>(1, g.getStart());
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::endExploration() {
+    finishExploration();
+
+    if (!checkpointPath.empty()) {
+        unlink(checkpointPath.c_str());
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::reportProgress(
+    size_t found,
+    size_t queued,
+    size_t inFlight,
+    unsigned limit) {
+    time_t const now = time(NULL);
+    if (now - lastReport < reportInterval) {
+        return;
+    }
+    std::cerr << "Explorer: " << found << " states found, " << queued
+              << " queued";
+    if (limit != 0) {
+        std::cerr << ", " << inFlight << " in flight (limit " << limit << ")";
+    }
+    std::cerr << std::endl;
+    lastReport = now;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::checkpointIfDue(
+    std::set<VertexProperty> const& vertexSet,
+    std::queue<VertexProperty> const& queued) {
+    if (!checkpointDue(time(NULL))) {
+        return;
+    }
+    std::set<VertexProperty> pending;
+    addPending(queued, pending);
+    writeCheckpoint(vertexSet, pending);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+template<typename Queued, typename InFlight>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::checkpointIfDue(
+    std::set<VertexProperty> const& vertexSet,
+    Queued const& queued,
+    InFlight const& inFlight) {
+    if (!checkpointDue(time(NULL))) {
+        return;
+    }
+    std::set<VertexProperty> pending;
+    addPending(queued, pending);
+    addPending(inFlight, pending);
+    writeCheckpoint(vertexSet, pending);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::addPending(
+    std::queue<VertexProperty> const& queued,
+    std::set<VertexProperty>& pending) {
+    for (std::queue<VertexProperty> q = queued; !q.empty(); q.pop()) {
+        pending.insert(q.front());
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::addPending(
+    ForkExploreStates const& inFlight,
+    std::set<VertexProperty>& pending) {
+    for (typename ForkExploreStates::const_iterator it = inFlight.begin(),
+             ie = inFlight.end(); it != ie; ++it) {
+        pending.insert(it->second.first);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::addPending(
+    SharedExploreStates const& inFlight,
+    std::set<VertexProperty>& pending) {
+    for (typename SharedExploreStates::const_iterator it = inFlight.begin(),
+             ie = inFlight.end(); it != ie; ++it) {
+        pending.insert(it->second.first);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::addPending(
+    std::deque<typename WorkerPool::Job> const& queued,
+    std::set<VertexProperty>& pending) {
+    for (typename std::deque<typename WorkerPool::Job>::const_iterator
+             it = queued.begin(), ie = queued.end(); it != ie; ++it) {
+        pending.insert(it->state);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::addPending(
+    std::map<unsigned, typename WorkerPool::Job> const& inFlight,
+    std::set<VertexProperty>& pending) {
+    for (typename std::map<unsigned, typename WorkerPool::Job>::const_iterator
+             it = inFlight.begin(), ie = inFlight.end(); it != ie; ++it) {
+        pending.insert(it->second.state);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::checkpointDue(
+    time_t now) const {
+    return (!checkpointPath.empty() &&
+            checkpointInterval > 0 &&
+            now - lastCheckpoint >= checkpointInterval);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::writeCheckpoint(
+    std::set<VertexProperty> const& visited,
+    std::set<VertexProperty> const& pending) {
+    std::vector<VertexProperty> const pendingList(pending.begin(), pending.end());
+    std::ostringstream oss;
+    {
+        boost::archive::text_oarchive oa(oss);
+        oa << g;
+        oa << visited;
+        oa << pendingList;
+    }
+    if (!writeFileAtomically(checkpointPath, oss.str())) {
+        std::cerr << "Explorer: failed to write checkpoint " << checkpointPath
+                  << ": " << std::strerror(errno) << std::endl;
+    }
+    lastCheckpoint = time(NULL);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+typename EdgeGeneratorType::OutputCollection
+GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploredCalls(
+    VertexProperty const& v) const {
+    typename EdgeGeneratorType::OutputCollection calls;
+    typename Graph::Graph const& graph = g.getGraph();
+    typename Graph::EdgeIterator it, ie;
+    for (boost::tie(it, ie) = boost::out_edges(g.getVertex(v), graph);
+         it != ie; ++it) {
+        EdgeProperty const& e = graph[*it];
+        calls.insert(typename EdgeGeneratorType::OutputItem(e.function(), e.params()));
+    }
+    typename Graph::EdgePropertyList const failed =
+        g.getFailedEdges(g.getVertex(v));
+    for (typename Graph::EdgePropertyList::const_iterator
+             fIt = failed.begin(), fIe = failed.end(); fIt != fIe; ++fIt) {
+        calls.insert(typename EdgeGeneratorType::OutputItem(fIt->function(), fIt->params()));
+    }
+    return calls;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploreAllPooled() {
+    typedef typename WorkerPool::Job Job;
+    typedef typename WorkerPool::Result Result;
+
+    // Workers start from (and return to) the explorer's state, which is
+    // where paths to unreachable-by-jump states begin
+    ASSERT(VertexProperty::get() == g.getStart());
+
+    WorkerPool pool(*this, workerPoolSize);
+    while (pool.start() == 0) {
+        std::cerr << "Worker pool: pipe/fork failed. Retrying..." << std::endl;
+        pool.stop();
+        forkController.backoff();
+    }
+
+    std::set<VertexProperty> vertexSet;
+    std::deque<Job> jobQueue;
+    std::map<unsigned, Job> inFlight;
+    // Failed attempts so far at jobs that are being retried
+    std::map<unsigned, unsigned> retries;
+    unsigned nextJobId = 0;
+
+    std::vector<VertexProperty> const initial = beginExploration(vertexSet);
+    for (typename std::vector<VertexProperty>::const_iterator
+             it = initial.begin(), ie = initial.end(); it != ie; ++it) {
+        enqueueCalls(*it, jobQueue, nextJobId);
+    }
+
+    while (!jobQueue.empty() || !inFlight.empty()) {
+        // Keep every worker busy
+        while (!jobQueue.empty() && pool.hasIdleWorker()) {
+            Job& job = jobQueue.front();
+            if (!canJumpToVertex(job.state)) {
+                job.hasPath = true;
+                job.path = getPathTo(job.state);
+            }
+            pool.submit(job);
+            inFlight.insert(std::make_pair(job.id, job));
+            jobQueue.pop_front();
+        }
+
+        Result const result = pool.collect();
+        typename std::map<unsigned, Job>::iterator jobIt =
+            inFlight.find(result.id);
+        if (jobIt == inFlight.end()) {
+            continue;
+        }
+        if (!result.ok) {
+            Job job = jobIt->second;
+            inFlight.erase(jobIt);
+            unsigned const failures = retries[job.id] + 1;
+            retries.erase(job.id);
+            if (failures > probeRetries) {
+                std::cerr << "Explorer: giving up on a call from "
+                          << job.state << std::endl;
+                __sync_fetch_and_add(&forkCounters().givenUp, 1);
+                continue;
+            }
+            std::cerr << "Worker pool: probe failed; requeueing..."
+                      << std::endl;
+            __sync_fetch_and_add(&forkCounters().retried, 1);
+            // Under a new id, so that a late result from the failed attempt
+            // is ignored
+            job.id = nextJobId++;
+            retries[job.id] = failures;
+            jobQueue.push_back(job);
+            continue;
+        }
+
+        Job const job = jobIt->second;
+        inFlight.erase(jobIt);
+        retries.erase(job.id);
+
+        std::vector<PathStep> steps(1, result.step);
+        impliedEdges(job.state, job.call, result.step, steps);
+        for (typename std::vector<PathStep>::const_iterator
+                 it = steps.begin(), ie = steps.end(); it != ie; ++it) {
+            VertexProperty const& v1 = job.state;
+            EdgeProperty const& e = it->edge;
+            VertexProperty const& v2 = it->nextVertex;
             g.addEdge(v1, v2, e);
-            // If edge leads to a new state, enqueue it
-            if (vertexSet.find(v2) == vertexSet.end()) {
-                vertexSet.insert(v2);
-                vertexQueue.push(v2);
+
+            // If edge leads to a new state, enqueue its calls
+            VertexProperty const next = discoverVertex(v1, e, v2);
+            if (vertexSet.find(next) == vertexSet.end()) {
+                vertexSet.insert(next);
+                enqueueCalls(next, jobQueue, nextJobId);
+            }
+        }
+
+        // Calls, rather than states, are queued and in flight
+        reportProgress(
+            vertexSet.size(), jobQueue.size(), inFlight.size(), pool.size());
+        checkpointIfDue(vertexSet, jobQueue, inFlight);
+    }
+
+    endExploration();
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploreAllInProcess() {
+    typedef typename ExploreStateType::Edge Edge;
+
+    std::set<VertexProperty> vertexSet;
+    std::queue<VertexProperty> vertexQueue;
+
+    std::vector<VertexProperty> const initial = beginExploration(vertexSet);
+    for (typename std::vector<VertexProperty>::const_iterator
+             it = initial.begin(), ie = initial.end(); it != ie; ++it) {
+        vertexQueue.push(*it);
+    }
+
+    while (!vertexQueue.empty()) {
+        VertexProperty const state = vertexQueue.front();
+        vertexQueue.pop();
+
+        typename EdgeGeneratorType::OutputCollection explored;
+        if (seeded) {
+            explored = exploredCalls(state);
+        }
+
+        typename ExploreStateType::Rtn edgeSet;
+        for (CallSet::iterator it = edges.begin(), ie = edges.end();
+             it != ie; ++it) {
+            if (explored.find(*it) != explored.end() ||
+                !shouldExploreCall(state, *it)) {
+                continue;
+            }
+            jumpToVertex(state);
+            EdgeProperty const e = exploreEdge(*it);
+            PathStep const ps(e, currentVertex());
+            edgeSet.insert(Edge(state, ps));
+
+            std::vector<PathStep> implied;
+            impliedEdges(state, *it, ps, implied);
+            for (typename std::vector<PathStep>::const_iterator
+                     iIt = implied.begin(), iIe = implied.end();
+                 iIt != iIe; ++iIt) {
+                edgeSet.insert(Edge(state, *iIt));
+            }
+        }
+        recordEdges(edgeSet, vertexSet, vertexQueue);
+
+        reportProgress(vertexSet.size(), vertexQueue.size(), 0, 0);
+        // Each state is explored in full before the next is popped
+        checkpointIfDue(vertexSet, vertexQueue);
+    }
+
+    endExploration();
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploreAllForkTree() {
+    typedef typename ExploreStateType::Edge Edge;
+
+    ASSERT(!seeded);
+    ASSERT(VertexProperty::get() == g.getStart());
+
+    // A count of extra forks, then one claim byte per vertex, shared by the
+    // whole process tree
+    size_t const numVertices = boost::num_vertices(g.getGraph());
+    size_t const sharedSize = sizeof(unsigned) + numVertices;
+    void* const shared = mmap(
+        NULL,
+        sharedSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANON,
+        -1,
+        0);
+    ASSERT(shared != MAP_FAILED);
+    std::memset(shared, 0, sharedSize);
+    unsigned* const extraForks = static_cast<unsigned*>(shared);
+    unsigned char* const claims =
+        static_cast<unsigned char*>(shared) + sizeof(unsigned);
+
+    FileDescriptor fd[2];
+    while (pipe(fd) == -1) {
+        forkController.backoff();
+    }
+
+    pid_t root;
+    while ((root = fork()) == -1) {
+        forkController.backoff();
+    }
+    if (root == 0) {
+        close(fd[0]);
+        claims[g.getVertex(g.getStart())] = 1;
+        exploreSubtree(g.getStart(), claims, extraForks, fd[1]);
+        exit(0);
+    }
+
+    // Every process in the tree holds the write end; reading stops once the
+    // last of them exits
+    close(fd[1]);
+    std::set<VertexProperty> vertexSet;
+    vertexSet.insert(g.getStart());
+    lastReport = time(NULL);
+    std::string payload;
+    while (readFrame(fd[0], payload)) {
+        Edge edge;
+        if (!archiveFromString(payload, edge)) {
+            // Frames are written whole, so the next one is still in step
+            std::cerr << "Explorer: dropped an unreadable edge" << std::endl;
+            __sync_fetch_and_add(&forkCounters().givenUp, 1);
+            continue;
+        }
+        g.addEdge(edge.vertex, edge.pathStep.nextVertex, edge.pathStep.edge);
+        vertexSet.insert(edge.pathStep.nextVertex);
+
+        time_t const now = time(NULL);
+        if (now - lastReport >= reportInterval) {
+            std::cerr << "Explorer: " << vertexSet.size() << " states found"
+                      << std::endl;
+            lastReport = now;
+        }
+    }
+    close(fd[0]);
+    waitpid(root, NULL, 0);
+    munmap(shared, sharedSize);
+
+    finishExploration();
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::exploreSubtree(
+    VertexProperty const& state,
+    unsigned char* claims,
+    unsigned* extraForks,
+    FileDescriptor results) {
+    typedef typename ExploreStateType::Edge Edge;
+
+    // In-flight children, and whether each holds an extra fork
+    std::map<pid_t, bool> children;
+
+    for (CallSet::iterator it = edges.begin(), ie = edges.end();
+         it != ie; ++it) {
+        pid_t pid;
+        bool extra;
+        for (;;) {
+            // Without a child in flight, a process always may fork, so that
+            // every subtree makes progress however busy the rest are
+            extra = !children.empty();
+            if (extra &&
+                !forkController.canDispatch(
+                    __sync_fetch_and_add(extraForks, 1))) {
+                __sync_fetch_and_sub(extraForks, 1);
+                reapSubtreeChild(state, children, extraForks);
+                continue;
+            }
+            pid = fork();
+            if (pid != -1) {
+                break;
+            }
+            forkController.forkFailed(errno);
+            if (extra) {
+                __sync_fetch_and_sub(extraForks, 1);
+                reapSubtreeChild(state, children, extraForks);
+            } else {
+                forkController.backoff();
+            }
+        }
+
+        if (pid == 0) {
+            EdgeProperty const e = exploreEdge(*it);
+            VertexProperty const next = VertexProperty::get();
+
+            std::string const payload =
+                archiveToString(Edge(state, PathStep(e, next)));
+            ASSERT(payload.size() <= maxAtomicFramePayload());
+            bool const written = writeFrame(results, payload);
+            ASSERT(written);
+            (void)written;
+
+            // First process to land in a state explores it
+            if (__sync_lock_test_and_set(&claims[g.getVertex(next)], 1) == 0) {
+                exploreSubtree(next, claims, extraForks, results);
             }
+            exit(0);
         }
 
-        // Double-buffer new states to writeBuffer (up to static class limits)
-        dispatchForkStates(vertexQueue, writeBuffer);
+        forkController.forkSucceeded();
+        children.insert(std::make_pair(pid, extra));
+    }
+
+    while (!children.empty()) {
+        reapSubtreeChild(state, children, extraForks);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::reapSubtreeChild(
+    VertexProperty const& state,
+    std::map<pid_t, bool>& children,
+    unsigned* extraForks) {
+    ASSERT(!children.empty());
+
+    // Grandchildren are reaped by their own parents, so any child that
+    // exits is one of these
+    int status = 0;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, 0)) == -1 && errno == EINTR) {}
+    std::map<pid_t, bool>::iterator child = children.find(pid);
+    ASSERT(child != children.end());
+    if (child->second) {
+        __sync_fetch_and_sub(extraForks, 1);
+    }
+    children.erase(child);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "Fork tree: exploration from " << state
+                  << " exited abnormally" << std::endl;
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::enqueueCalls(
+    VertexProperty const& v,
+    std::deque<typename WorkerPool::Job>& jobQueue,
+    unsigned& nextJobId) {
+    typename EdgeGeneratorType::OutputCollection explored;
+    if (seeded) {
+        explored = exploredCalls(v);
+    }
+    for (CallSet::iterator it = edges.begin(), ie = edges.end();
+         it != ie; ++it) {
+        if (explored.find(*it) == explored.end() &&
+            shouldExploreCall(v, *it)) {
+            jobQueue.push_back(typename WorkerPool::Job(nextJobId++, v, *it));
+        }
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::collectForkStates(
+    std::set<VertexProperty>& vertexSet,
+    std::queue<VertexProperty>& vertexQueue,
+    ForkExploreStates& forkStates) {
+    std::vector<struct pollfd> fds;
+    for (typename ForkExploreStates::const_iterator it = forkStates.begin(),
+             ie = forkStates.end(); it != ie; ++it) {
+        struct pollfd pfd;
+        pfd.fd = it->first;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        fds.push_back(pfd);
+    }
+
+    if (poll(&fds[0], fds.size(), -1) == -1) {
+        ASSERT(errno == EINTR);
+        return;
+    }
+
+    for (std::vector<struct pollfd>::const_iterator it = fds.begin(),
+             ie = fds.end(); it != ie; ++it) {
+        if (it->revents == 0) {
+            continue;
+        }
+        typename ForkExploreStates::iterator forkState =
+            forkStates.find(it->fd);
+        ASSERT(forkState != forkStates.end());
+        readForkState(forkState, vertexSet, vertexQueue, forkStates);
+
+        // Refill the freed slot right away
+        dispatchForkStates(vertexQueue, forkStates);
+    }
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::readForkState(
+    typename ForkExploreStates::iterator forkState,
+    std::set<VertexProperty>& vertexSet,
+    std::queue<VertexProperty>& vertexQueue,
+    ForkExploreStates& forkStates) {
+    VertexProperty const state = forkState->second.first;
+    typename ExploreStateType::Rtn edgeSet;
+    bool const complete = forkState->second.second.tryRead(edgeSet);
+    // Reading closed the pipe (and reaped the child), so its descriptor may
+    // be reused by the next dispatch
+    forkStates.erase(forkState);
+    if (!complete) {
+        std::cerr << "Explorer: exploration of " << state
+                  << " ended without a result; retrying" << std::endl;
+        __sync_fetch_and_add(&forkCounters().retried, 1);
+        vertexQueue.push(state);
+        return;
+    }
+
+    recordEdges(edgeSet, vertexSet, vertexQueue);
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::recordEdges(
+    typename ExploreStateType::Rtn const& edgeSet,
+    std::set<VertexProperty>& vertexSet,
+    std::queue<VertexProperty>& vertexQueue) {
+    // Construct each edge found
+    for (typename ExploreStateType::Rtn::const_iterator
+             esrIt = edgeSet.begin(), esrIe = edgeSet.end();
+         esrIt != esrIe; ++esrIt) {
+        VertexProperty const& v1 = esrIt->vertex;
+        EdgeProperty const& e = esrIt->pathStep.edge;
+        VertexProperty const& v2 = esrIt->pathStep.nextVertex;
+        g.addEdge(v1, v2, e);
+        // If edge leads to a new state, enqueue it
+        VertexProperty const next = discoverVertex(v1, e, v2);
+        if (vertexSet.find(next) == vertexSet.end()) {
+            vertexSet.insert(next);
+            vertexQueue.push(next);
+        }
     }
 }
 
@@ -92,33 +955,27 @@ template<typename VertexProperty, typename EdgeProperty, typename VertexGenerato
 unsigned GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::dispatchForkStates(
     std::queue<VertexProperty>& vertexQueue, ForkExploreStates& forkStates) {
     unsigned newlyDispatched = 0;
-    unsigned failures = 0;
     while (!vertexQueue.empty() &&
-           failures < forkFailureThreshold &&
-           numStateForks < stateForkLimit) {
+           forkController.canDispatch(forkStates.size())) {
         VertexProperty state = vertexQueue.front();
-        forkStates.push_back(ForkExploreState(ExploreStateType(*this)));
-        if (forkStates.back().run(state) != -1) {
+        ForkExploreState forkState = ForkExploreState(ExploreStateType(*this));
+        FileDescriptor const fd = forkState.run(state);
+        if (fd != -1) {
             // Only remove element from vertex queue if the fork succeeded
+            forkStates.insert(std::make_pair(fd, std::make_pair(state, forkState)));
             vertexQueue.pop();
-            ++numStateForks;
+            forkController.forkSucceeded();
             ++newlyDispatched;
         } else {
-            // If the fork failed, ditch the Fork object; we'll try again
-            forkStates.pop_back();
-            ++failures;
+            forkController.forkFailed(errno);
+            // Finishing states will free up resources; only wait out the
+            // failure if there is nothing to collect in the meantime
+            if (!forkStates.empty()) {
+                break;
+            }
+            forkController.backoff();
         }
     }
-    if (failures >= forkFailureThreshold) {
-        std::cerr << "Fork failure threshold reached; still trying..."
-                  << std::endl;
-        sleep(failureSleepTime);
-    }
-
-    if (forkStates.size() >= stateForkLimit) {
-        std::cerr << "State fork limit reached; still trying..."
-                  << std::endl;
-    }
     return newlyDispatched;
 }
 
@@ -135,12 +992,12 @@ ExploreCall<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType
     if (e.canJumpToVertex(startVertex)) {
         e.jumpToVertex(startVertex);
     } else {
-        e.followPath(e.g.getPath(startVertex));
+        e.followPath(e.getPathTo(startVertex));
     }
 
 #else
 
-    e.followPath(e.g.getPath(startVertex));
+    e.followPath(e.getPathTo(startVertex));
 
 #endif
 
@@ -157,24 +1014,62 @@ ExploreState<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorTyp
     Param const& param) {
     VertexProperty state = param;
     Rtn rtn;
-    ForkExploreCalls exploreCalls;
+
+    // When resuming, calls made before the checkpoint are already in the
+    // graph
+    typename EdgeGeneratorType::OutputCollection explored;
+    if (e.seeded) {
+        explored = e.exploredCalls(state);
+    }
 
     for (CallSet::iterator it = e.edges.begin(), ie = e.edges.end();
          it != ie; ++it) {
-        exploreCalls.push_back(ForkExploreCall(ExploreCallType(e)));
-        exploreCalls.back().run(typename ExploreCallType::Param(state, *it));
+        if (explored.find(*it) != explored.end() ||
+            !e.shouldExploreCall(state, *it)) {
+            continue;
+        }
         // Do individual call explorations for a state in series;
         // parallelization is managed at the state dispatch level
-        exploreCalls.back().wait();
-    }
-    for (typename ForkExploreCalls::iterator it = exploreCalls.begin(),
-             ie = exploreCalls.end(); it != ie; ++it) {
-        PathStep const& ps = it->read();
+        PathStep ps;
+        if (!e.probeCall(state, *it, ps)) {
+            std::cerr << "Explorer: giving up on a call from " << state
+                      << std::endl;
+            __sync_fetch_and_add(&forkCounters().givenUp, 1);
+            continue;
+        }
         rtn.insert(Edge(state, ps));
+
+        std::vector<PathStep> implied;
+        e.impliedEdges(state, *it, ps, implied);
+        for (typename std::vector<PathStep>::const_iterator
+                 iIt = implied.begin(), iIe = implied.end(); iIt != iIe; ++iIt) {
+            rtn.insert(Edge(state, *iIt));
+        }
     }
     return rtn;
 }
 
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+bool GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::probeCall(
+    VertexProperty const& state,
+    typename EdgeGeneratorType::OutputItem const& call,
+    PathStep& step) {
+    for (unsigned attempt = 0; attempt <= probeRetries; ++attempt) {
+        if (attempt > 0) {
+            __sync_fetch_and_add(&forkCounters().retried, 1);
+        }
+        ForkExploreCall forkCall = ForkExploreCall(ExploreCallType(*this));
+        forkCall.setTimeout(probeTimeout);
+        while (forkCall.run(typename ExploreCallType::Param(state, call)) == -1) {
+            forkController.backoff();
+        }
+        if (forkCall.tryRead(step)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
 void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::followPath(
     Path const& path) {
@@ -184,7 +1079,7 @@ void GraphExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGenera
         VertexProperty const& v = it->nextVertex;
 
         exploreEdge(
-            typename EdgeGeneratorType::OutputItem(e.function, e.params));
+            typename EdgeGeneratorType::OutputItem(e.function(), e.params()));
 
         ASSERT(VertexProperty::get() == v);
     }
@@ -196,17 +1091,259 @@ class SetuidStateGraphExplorer :
 public:
     typedef SetuidStateGraph<SetuidState, EdgeProperty, VertexGeneratorType, EdgeGeneratorType> Graph;
     typedef GraphExplorer<SetuidState, EdgeProperty, VertexGeneratorType, EdgeGeneratorType> Super;
+    typedef typename Super::Path Path;
+    typedef typename Super::PathStep PathStep;
+    typedef typename EdgeGeneratorType::OutputItem Call;
 
     SetuidStateGraphExplorer(
         Graph _g,
         EdgeGeneratorType const& edgeGenerator,
         typename EdgeGeneratorType::VertexInputCollection const& genInput1,
         typename EdgeGeneratorType::EdgeInputCollection const& genInput2) :
-        Super(_g, edgeGenerator, genInput1, genInput2) {}
+        Super(_g, edgeGenerator, genInput1, genInput2),
+        symmetric(false),
+        symmetryUIDs(),
+        symmetry(),
+        witnesses(),
+        callClasses(false),
+        hasCachedClasses(false),
+        cachedClassState(),
+        cachedClasses() {}
 
     virtual ~SetuidStateGraphExplorer() {}
 
+    // Explore one state (and, from it, one call) per orbit under permutations
+    // of the UIDs other than 0, -1 and those of the start state; the full
+    // graph over uids is rebuilt from the representatives once exploration
+    // finishes. Cannot be combined with a seeded exploration
+    void enableSymmetryReduction(UIDSet const& uids) {
+        SetuidState const& start = this->g.getStart();
+        UIDSet fixed;
+        fixed.insert(0);
+        fixed.insert(static_cast<UID>(0 - 1));
+        fixed.insert(start.ruid);
+        fixed.insert(start.euid);
+        fixed.insert(start.svuid);
+
+        symmetric = true;
+        symmetryUIDs = uids;
+        symmetry = UIDSymmetry(uids, fixed);
+    }
+
+    // Probe one call per class of calls that behave alike from a given
+    // state (see callClass()); the edges of the other calls in the class
+    // are derived from its outcome
+    void enableCallClasses() { callClasses = true; }
+
 protected:
+    // How a representative state was first reached: an edge to a state in
+    // its orbit
+    struct Witness {
+        Witness(
+            SetuidState const& _from,
+            EdgeProperty const& _edge,
+            SetuidState const& _to) :
+            from(_from), edge(_edge), to(_to) {}
+
+        SetuidState from;
+        EdgeProperty edge;
+        SetuidState to;
+    };
+    typedef std::map<SetuidState, Witness> WitnessMap;
+
+    bool symmetric;
+    UIDSet symmetryUIDs;
+    UIDSymmetry symmetry;
+    WitnessMap witnesses;
+
+    typedef std::pair<SetuidFunction, CallClass> CallClassKey;
+    typedef std::map<CallClassKey, std::vector<Call> > CallClassMap;
+
+    bool callClasses;
+    mutable bool hasCachedClasses;
+    mutable SetuidState cachedClassState;
+    mutable CallClassMap cachedClasses;
+
+    virtual SetuidState discoverVertex(
+        SetuidState const& from,
+        EdgeProperty const& edge,
+        SetuidState const& to) {
+        if (!symmetric) {
+            return to;
+        }
+        SetuidState const rep = symmetry.representative(to);
+        if (!(rep == this->g.getStart()) &&
+            witnesses.find(rep) == witnesses.end()) {
+            witnesses.insert(std::make_pair(rep, Witness(from, edge, to)));
+        }
+        return rep;
+    }
+
+    virtual bool shouldExploreCall(SetuidState const& ss, Call const& call) const {
+        if (!isSymmetryRepresentative(ss, call)) {
+            return false;
+        }
+        if (!callClasses) {
+            return true;
+        }
+        CallClassMap const& classes = classesFrom(ss);
+        typename CallClassMap::const_iterator it =
+            classes.find(CallClassKey(call.function, callClass(ss, call.params)));
+        ASSERT(it != classes.end());
+        return it->second.front() == call;
+    }
+
+    bool isSymmetryRepresentative(SetuidState const& ss, Call const& call) const {
+        return !symmetric || symmetry.isRepresentative(ss, call.params);
+    }
+
+    // Every other call of the probed call's class ends up in the
+    // corresponding state
+    virtual void impliedEdges(
+        SetuidState const& ss,
+        Call const& call,
+        PathStep const& outcome,
+        std::vector<PathStep>& implied) const {
+        if (!callClasses) {
+            return;
+        }
+        CallClassMap const& classes = classesFrom(ss);
+        typename CallClassMap::const_iterator it =
+            classes.find(CallClassKey(call.function, callClass(ss, call.params)));
+        ASSERT(it != classes.end());
+        ASSERT(it->second.front() == call);
+        for (typename std::vector<Call>::const_iterator
+                 mIt = it->second.begin() + 1, mIe = it->second.end();
+             mIt != mIe; ++mIt) {
+            EdgeProperty edge = outcome.edge;
+            edge.setParams(mIt->params);
+            implied.push_back(PathStep(
+                edge,
+                memberOutcome(call.params, mIt->params, outcome.nextVertex)));
+        }
+    }
+
+    // Calls (that symmetry reduction would make) from ss, grouped by class;
+    // the first call of each class is the one probed
+    CallClassMap const& classesFrom(SetuidState const& ss) const {
+        if (hasCachedClasses && cachedClassState == ss) {
+            return cachedClasses;
+        }
+        cachedClasses.clear();
+        for (typename EdgeGeneratorType::OutputCollection::const_iterator
+                 it = this->edges.begin(), ie = this->edges.end();
+             it != ie; ++it) {
+            if (isSymmetryRepresentative(ss, *it)) {
+                cachedClasses[CallClassKey(it->function, callClass(ss, it->params))]
+                    .push_back(*it);
+            }
+        }
+        cachedClassState = ss;
+        hasCachedClasses = true;
+        return cachedClasses;
+    }
+
+    // Representatives may never be reached directly; a path to one is the
+    // relabeled path to its witness
+    virtual Path getPathTo(SetuidState const& ss) const {
+        if (!symmetric) {
+            return Super::getPathTo(ss);
+        }
+        if (ss == this->g.getStart()) {
+            return Path();
+        }
+        typename WitnessMap::const_iterator wIt = witnesses.find(ss);
+        ASSERT(wIt != witnesses.end());
+        Witness const& w = wIt->second;
+
+        Path path = getPathTo(w.from);
+        path.push_back(PathStep(w.edge, w.to));
+        if (w.to == ss) {
+            return path;
+        }
+
+        UIDRelabeling r = symmetry.canonicalize(w.to);
+        for (typename Path::const_iterator it = path.begin(), ie = path.end();
+             it != ie; ++it) {
+            symmetry.extend(r, it->edge.params());
+            symmetry.extend(r, it->nextVertex);
+        }
+        Path relabeled;
+        for (typename Path::const_iterator it = path.begin(), ie = path.end();
+             it != ie; ++it) {
+            EdgeProperty edge = it->edge;
+            edge.setParams(r.map(edge.params()));
+            relabeled.push_back(PathStep(edge, r.map(it->nextVertex)));
+        }
+        ASSERT(relabeled.back().nextVertex == ss);
+        return relabeled;
+    }
+
+    // Rebuild the full graph: each (state, call) takes the outcome of its
+    // representative, relabeled back
+    virtual void finishExploration() {
+        if (!symmetric) {
+            return;
+        }
+
+        typedef typename Graph::Graph BoostGraph;
+        typedef std::pair<EdgeProperty, SetuidState> Outcome;
+        typedef std::map<Call, Outcome> OutcomeMap;
+        BoostGraph const& reduced = this->g.getGraph();
+
+        std::map<SetuidState, OutcomeMap> outcomes;
+        typename boost::graph_traits<BoostGraph>::edge_iterator eIt, eIe;
+        for (boost::tie(eIt, eIe) = boost::edges(reduced); eIt != eIe; ++eIt) {
+            EdgeProperty const& edge = reduced[*eIt];
+            outcomes[reduced[boost::source(*eIt, reduced)]].insert(
+                std::make_pair(
+                    Call(edge.function(), edge.params()),
+                    Outcome(edge, reduced[boost::target(*eIt, reduced)])));
+        }
+        typename boost::graph_traits<BoostGraph>::vertex_iterator vIt, vIe;
+        for (boost::tie(vIt, vIe) = boost::vertices(reduced); vIt != vIe; ++vIt) {
+            typename Graph::EdgePropertyList const failed =
+                this->g.getFailedEdges(*vIt);
+            for (typename Graph::EdgePropertyList::const_iterator
+                     it = failed.begin(), ie = failed.end(); it != ie; ++it) {
+                outcomes[reduced[*vIt]].insert(
+                    std::make_pair(
+                        Call(it->function(), it->params()),
+                        Outcome(*it, reduced[*vIt])));
+            }
+        }
+
+        Graph full(VertexGeneratorType(), symmetryUIDs, this->g.getStart());
+        full.beginBulkInsert();
+        for (boost::tie(vIt, vIe) = boost::vertices(reduced); vIt != vIe; ++vIt) {
+            SetuidState const& v = reduced[*vIt];
+            UIDRelabeling const r = symmetry.canonicalize(v);
+            typename std::map<SetuidState, OutcomeMap>::const_iterator oIt =
+                outcomes.find(r.map(v));
+            // Orbit never reached
+            if (oIt == outcomes.end()) {
+                continue;
+            }
+
+            for (typename EdgeGeneratorType::OutputCollection::const_iterator
+                     cIt = this->edges.begin(), cIe = this->edges.end();
+                 cIt != cIe; ++cIt) {
+                UIDRelabeling rc = r;
+                symmetry.extend(rc, cIt->params);
+                typename OutcomeMap::const_iterator outcome = oIt->second.find(
+                    Call(cIt->function, rc.map(cIt->params)));
+                ASSERT(outcome != oIt->second.end());
+
+                EdgeProperty edge = outcome->second.first;
+                edge.setParams(cIt->params);
+                full.addEdge(v, rc.unmap(outcome->second.second), edge);
+            }
+        }
+        full.endBulkInsert();
+
+        this->g = full;
+    }
+
     virtual bool canJumpToVertex(SetuidState const& ss) const {
         return (HAS_SETRESUID) && !isPartiallyHiddenState(ss);
     }
@@ -225,6 +1362,34 @@ protected:
 
         this->exploreEdge(typename EdgeGeneratorType::OutputItem(Setresuid, sfp));
     }
+
+    // A process can jump back to the start state as long as one of its UIDs
+    // stays 0. Only calls that provably leave a 0 in place (whether they
+    // succeed or fail) are considered safe
+    virtual bool mayLosePrivilege(
+        SetuidState const& ss,
+        typename EdgeGeneratorType::OutputItem const& call) const {
+        switch (call.function) {
+        default:
+            return true;
+        case Seteuid:
+            return !(ss.ruid == 0 || ss.svuid == 0);
+        case Setreuid:
+            ASSERT(call.params.size() == 2);
+            return !((ss.ruid == 0 && keepsRoot(call.params.at(0))) ||
+                     (ss.euid == 0 && keepsRoot(call.params.at(1))));
+        case Setresuid:
+            ASSERT(call.params.size() == 3);
+            return !((ss.ruid == 0 && keepsRoot(call.params.at(0))) ||
+                     (ss.euid == 0 && keepsRoot(call.params.at(1))) ||
+                     (ss.svuid == 0 && keepsRoot(call.params.at(2))));
+        }
+    }
+
+    static bool keepsRoot(UID param) {
+        static UID const special = 0 - 1;
+        return param == 0 || param == special;
+    }
 };
 
 template<typename VertexGeneratorType, typename EdgeGeneratorType>
@@ -239,13 +1404,106 @@ public:
         EdgeGeneratorType const& edgeGenerator,
         typename EdgeGeneratorType::VertexInputCollection const& genInput1,
         typename EdgeGeneratorType::EdgeInputCollection const& genInput2) :
-        Super(_g, edgeGenerator, genInput1, genInput2) {}
+        Super(_g, edgeGenerator, genInput1, genInput2),
+        cloneProbes(false),
+        simulated(false),
+        model(),
+        simulatedState() {}
 
     virtual ~SetuidStateCallGraphExplorer() {}
 
+    // Make calls on a model of the kernel's credentials instead of on real
+    // processes: exploration runs in process, without forking or needing
+    // root, and takes precedence over the other strategies. Only
+    // setuid-family calls can be simulated
+    void simulate(CredentialModel const& _model) {
+        simulated = true;
+        model = _model;
+    }
+
+    // Make setuid-family calls in clone()d probes that share the explorer's
+    // memory (see CloneProbe.h) rather than in forked children; other calls,
+    // and platforms without clone(), still fork
+    void setCloneProbes(bool enabled) { cloneProbes = enabled; }
+
 protected:
+    typedef typename Super::Path Path;
+    typedef typename Super::PathStep PathStep;
+    typedef typename EdgeGeneratorType::OutputItem Call;
+
+    bool cloneProbes;
+    bool simulated;
+    CredentialModel model;
+    SetuidState simulatedState;
+
+    virtual bool probeCall(
+        SetuidState const& state,
+        Call const& call,
+        PathStep& step) {
+        if (!cloneProbes || !canCloneProbe(call.function)) {
+            return Super::probeCall(state, call, step);
+        }
+
+        // Get to state the way a forked child would
+        std::vector<ProbeCall> calls;
+        if (this->canJumpToVertex(state)) {
+            SetuidFunctionParams sfp;
+            sfp.push_back(state.ruid);
+            sfp.push_back(state.euid);
+            sfp.push_back(state.svuid);
+            calls.push_back(ProbeCall(Setresuid, sfp));
+        } else {
+            Path const path = this->getPathTo(state);
+            for (typename Path::const_iterator it = path.begin(), ie = path.end();
+                 it != ie; ++it) {
+                if (!canCloneProbe(it->edge.function())) {
+                    return Super::probeCall(state, call, step);
+                }
+                calls.push_back(ProbeCall(it->edge.function(), it->edge.params()));
+            }
+        }
+        calls.push_back(ProbeCall(call.function, call.params));
+
+        ProbeResult result;
+        if (!cloneProbe(&calls[0], calls.size(), result)) {
+            return Super::probeCall(state, call, step);
+        }
+        SetuidFunctionReturn const rtn = result.value == 0 ?
+            SetuidFunctionReturn(result.value, 0) :
+            SetuidFunctionReturn(result.value, result.errNumber);
+        step = PathStep(
+            SetuidFunctionCall(call.function, call.params, rtn),
+            result.state);
+        return true;
+    }
+
+    virtual bool exploresInProcess() const { return simulated; }
+
+    virtual SetuidState currentVertex() const {
+        return simulated ? simulatedState : Super::currentVertex();
+    }
+
+    virtual bool canJumpToVertex(SetuidState const& ss) const {
+        return simulated || Super::canJumpToVertex(ss);
+    }
+
+    virtual void jumpToVertex(SetuidState const& ss) {
+        if (simulated) {
+            simulatedState = ss;
+            return;
+        }
+        Super::jumpToVertex(ss);
+    }
+
     SetuidFunctionCall exploreEdge(
         typename EdgeGeneratorType::OutputItem const& call) {
+        if (simulated) {
+            return SetuidFunctionCall(
+                call.function,
+                call.params,
+                model.apply(simulatedState, call.function, call.params));
+        }
+
         int success;
         switch (call.function) {
         default:
@@ -288,8 +1546,8 @@ protected:
             break;
         }
         SetuidFunctionReturn rtn = success == 0 ?
-            SetuidFunctionReturn(success, 0, "") :
-            SetuidFunctionReturn(success, errno, std::strerror(errno));
+            SetuidFunctionReturn(success, 0) :
+            SetuidFunctionReturn(success, errno);
         return SetuidFunctionCall(call.function, call.params, rtn);
     }
 };
@@ -328,32 +1586,166 @@ public:
     // Individual call explorers don't work like this
     virtual void exploreAll() { ASSERT(false); }
 
-    // TODO: This interface is slow; we should keep run and read decoupled and
-    // possibly manage pipe/fork failures in a more nuanced way
-    virtual Rtn exploreOne(
-        Param const& param) {
-        Functor* functor = new Functor(*this);
-        while (functor->run(param) == -1) {
-            std::cerr << "Individual call explorer: pipe/fork failed. "
-                      << "Retrying..." << std::endl;
-            sleep(1);
-        }
-        Rtn rtn = functor->read();
-        functorQueue.push(functor);
-        while (functorQueue.size() >= forkLimit) {
-            Functor* f = functorQueue.front();
-            f->wait();
-            functorQueue.pop();
-            delete f;
+    // Probe a single call, waiting for its result; false if every attempt
+    // ended without one. See exploreBatch() for probing many at once
+    virtual bool exploreOne(
+        Param const& param,
+        Rtn& rtn) {
+        for (unsigned attempt = 0; attempt <= this->probeRetries; ++attempt) {
+            if (attempt > 0) {
+                __sync_fetch_and_add(&forkCounters().retried, 1);
+            }
+            Functor* functor = new Functor(*this);
+            while (functor->run(param) == -1) {
+                std::cerr << "Individual call explorer: pipe/fork failed. "
+                          << "Retrying..." << std::endl;
+                sleep(1);
+            }
+            bool const complete = functor->tryRead(rtn);
+            functorQueue.push(functor);
+            while (functorQueue.size() >= forkLimit) {
+                Functor* f = functorQueue.front();
+                f->wait();
+                functorQueue.pop();
+                delete f;
+            }
+            if (complete) {
+                return true;
+            }
         }
-        return rtn;
+        return false;
     }
 
+    // Probe every one of params, keeping as many probes in flight as the
+    // fork controller allows, and hand each result to collector(i, rtn),
+    // where i indexes params, in the order that probes complete. Probes
+    // that die or time out are retried; returns the number given up on
+    template<typename Collector>
+    unsigned exploreBatch(std::vector<Param> const& params, Collector& collector);
+
 private:
+    // In-flight probes, keyed by the pipe each one reports on: the index of
+    // the probe's param, its deadline (if it has a timeout) and the probe
+    struct InFlight {
+        InFlight(unsigned _index, long _deadline, Functor const& _probe) :
+            index(_index), deadline(_deadline), probe(_probe) {}
+
+        unsigned index;
+        long deadline;
+        Functor probe;
+    };
+    typedef std::map<FileDescriptor, InFlight> InFlightMap;
+
     std::queue<Functor*> functorQueue;
     static unsigned const forkLimit = 8;
 };
 
+template<
+    typename VertexProperty,
+    typename EdgeProperty,
+    typename VertexGeneratorType,
+    typename EdgeGeneratorType,
+    typename FunctorType>
+template<typename Collector>
+unsigned IndividualCallExplorer<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType, FunctorType>::exploreBatch(
+    std::vector<Param> const& params,
+    Collector& collector) {
+    std::deque<unsigned> pending;
+    for (unsigned i = 0; i < params.size(); ++i) {
+        pending.push_back(i);
+    }
+    std::vector<unsigned> attempts(params.size(), 0);
+    InFlightMap inFlight;
+    unsigned givenUp = 0;
+
+    while (!pending.empty() || !inFlight.empty()) {
+        // Any free slot takes the next probe, whichever state it is from
+        while (!pending.empty() &&
+               this->forkController.canDispatch(inFlight.size())) {
+            unsigned const index = pending.front();
+            Functor probe = Functor(FunctorType(*this));
+            probe.setTimeout(this->probeTimeout);
+            FileDescriptor const fd = probe.run(params.at(index));
+            if (fd != -1) {
+                long const deadline = this->probeTimeout == 0 ?
+                    0 : monotonicMillis() + this->probeTimeout;
+                inFlight.insert(
+                    std::make_pair(fd, InFlight(index, deadline, probe)));
+                pending.pop_front();
+                this->forkController.forkSucceeded();
+            } else {
+                this->forkController.forkFailed(errno);
+                if (!inFlight.empty()) {
+                    break;
+                }
+                this->forkController.backoff();
+            }
+        }
+        if (inFlight.empty()) {
+            continue;
+        }
+
+        std::vector<struct pollfd> fds;
+        long earliest = 0;
+        for (typename InFlightMap::const_iterator it = inFlight.begin(),
+                 ie = inFlight.end(); it != ie; ++it) {
+            struct pollfd pfd;
+            pfd.fd = it->first;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            fds.push_back(pfd);
+            if (it->second.deadline != 0 &&
+                (earliest == 0 || it->second.deadline < earliest)) {
+                earliest = it->second.deadline;
+            }
+        }
+        long const now = monotonicMillis();
+        int const wait = earliest == 0 ? -1 :
+            earliest <= now ? 0 : static_cast<int>(earliest - now);
+        if (poll(&fds[0], fds.size(), wait) == -1) {
+            ASSERT(errno == EINTR);
+            continue;
+        }
+
+        long const after = monotonicMillis();
+        for (std::vector<struct pollfd>::const_iterator it = fds.begin(),
+                 ie = fds.end(); it != ie; ++it) {
+            typename InFlightMap::iterator probe = inFlight.find(it->fd);
+            ASSERT(probe != inFlight.end());
+            bool const overdue =
+                probe->second.deadline != 0 && probe->second.deadline <= after;
+            if (it->revents == 0 && !overdue) {
+                continue;
+            }
+            if (it->revents == 0) {
+                // Hung; with almost no time left, reading kills it
+                probe->second.probe.setTimeout(1);
+            }
+
+            unsigned const index = probe->second.index;
+            Rtn rtn;
+            bool const complete = probe->second.probe.tryRead(rtn);
+            // Reading closed the pipe (and reaped the child), so its
+            // descriptor may be reused by the next dispatch
+            inFlight.erase(probe);
+            if (complete) {
+                collector(index, rtn);
+            } else if (attempts.at(index)++ < this->probeRetries) {
+                __sync_fetch_and_add(&forkCounters().retried, 1);
+                pending.push_back(index);
+            } else {
+                std::cerr << "Individual call explorer: probe " << index
+                          << " (" << params.at(index) << ") ended without a "
+                          << "result; giving up" << std::endl;
+                __sync_fetch_and_add(&forkCounters().givenUp, 1);
+                ++givenUp;
+            }
+        }
+    }
+
+    return givenUp;
+}
+
 template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
 typename ExplorePriv2Call<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::Rtn
 ExplorePriv2Call<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::operator() (
@@ -25,6 +25,8 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
+#include <queue>
 #include <utility>
 #include <vector>
 
@@ -371,10 +373,13 @@ SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGenerato
     VertexGeneratorType const& generator,
     typename VertexGeneratorType::InputCollection const& ic,
     VertexProperty const& _start) :
-    start(_start) {
+    start(_start),
+    bulkInsert(false),
+    shortestPathsDirty(false) {
     typename VertexGeneratorType::OutputCollection vs =
         generator.generateAll(ic);
     ASSERT(vs.find(start) != vs.end());
+    failures = FailedCallTable<EdgeProperty>(vs.size());
     pred = PredecessorList(vs.size());
     dist = DistanceList(vs.size());
     for (typename VertexGeneratorType::OutputCollection::const_iterator it =
@@ -389,8 +394,11 @@ SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGenerato
     SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType> const& ssg,
     VertexProperty const& _start) :
     g(ssg.g),
+    failures(ssg.failures),
     start(_start),
-    vPropMap(ssg.vPropMap) {
+    vPropMap(ssg.vPropMap),
+    bulkInsert(false),
+    shortestPathsDirty(false) {
     unsigned const numVertices = boost::num_vertices(g);
     pred = PredecessorList(numVertices);
     dist = DistanceList(numVertices);
@@ -401,6 +409,7 @@ template<typename VertexProperty, typename EdgeProperty, typename VertexGenerato
 typename SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::Path
 SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getPath(
     VertexProperty const& sv) const {
+    ensureShortestPaths();
     typename VertexPropertyMap::const_iterator vCurrentItr = vPropMap.find(sv);
     ASSERT(vCurrentItr != vPropMap.end());
     Path path;
@@ -434,8 +443,19 @@ void SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGen
     typename VertexPropertyMap::const_iterator itr1 = vPropMap.find(v1);
     typename VertexPropertyMap::const_iterator itr2 = vPropMap.find(v2);
     ASSERT(itr1 != vPropMap.end() && itr2 != vPropMap.end());
+    // A failed call cannot shorten any path
+    if (itr1->second == itr2->second && failures.isFailure(e)) {
+        failures.add(get(boost::vertex_index, g, itr1->second), e);
+        return;
+    }
     add_edge(itr1->second, itr2->second, e, g);
-    computeShortestPaths();
+    // Adding an edge can only shorten paths, so existing shortest-path data
+    // can be patched in place; stale data is left for the next query
+    if (bulkInsert) {
+        shortestPathsDirty = true;
+    } else if (!shortestPathsDirty) {
+        relaxShortestPaths(itr1->second, itr2->second);
+    }
 }
 
 template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
@@ -461,6 +481,7 @@ SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGenerato
 template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
 VertexProperty const& SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::getPredecessor(
     VertexProperty const& v) const {
+    ensureShortestPaths();
     typename VertexPropertyMap::const_iterator vItr = vPropMap.find(v);
     ASSERT(vItr != vPropMap.end());
     Vertex vertex = vItr->second;
@@ -473,14 +494,86 @@ VertexProperty const& SetuidStateGraph<VertexProperty, EdgeProperty, VertexGener
 }
 
 template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
-void SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::computeShortestPaths() {
-    ASSERT(vPropMap.find(start) != vPropMap.end());
+void SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::computeShortestPaths() const {
+    typename VertexPropertyMap::const_iterator startItr = vPropMap.find(start);
+    ASSERT(startItr != vPropMap.end());
     boost::dijkstra_shortest_paths(
         g,
-        vPropMap[start],
+        startItr->second,
         weight_map(get(&EdgeProperty::weight, g)).
         predecessor_map(make_iterator_property_map(
                             pred.begin(), get(boost::vertex_index, g))).
         distance_map(make_iterator_property_map(
                          dist.begin(), get(boost::vertex_index, g))));
+    shortestPathsDirty = false;
+}
+
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::ensureShortestPaths() const {
+    if (shortestPathsDirty) {
+        computeShortestPaths();
+    }
+}
+
+// Decrease-only update after inserting v1 -> v2: propagate any shortened
+// distance breadth-first from v2. With unit weights each vertex is improved at
+// most once per insertion, so building a graph edge-by-edge stays roughly
+// linear in the number of edges (instead of one Dijkstra per edge)
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::relaxShortestPaths(
+    Vertex const& v1,
+    Vertex const& v2) {
+    static Distance const infinity = std::numeric_limits<Distance>::max();
+    std::queue<Vertex> relaxed;
+    Distance const d1 = dist.at(get(boost::vertex_index, g, v1));
+    if (d1 == infinity) {
+        return;
+    }
+    relaxed.push(v1);
+    while (!relaxed.empty()) {
+        Vertex const u = relaxed.front();
+        relaxed.pop();
+        Distance const du = dist.at(get(boost::vertex_index, g, u));
+        // Only edges into v2 can have changed on the first step
+        std::pair<EdgeIterator, EdgeIterator> edges = u == v1 ?
+            boost::edge_range(v1, v2, g) :
+            boost::out_edges(u, g);
+        for (; edges.first != edges.second; ++edges.first) {
+            Vertex const v = target(*edges.first, g);
+            Distance const dv = du + static_cast<Distance>(
+                get(boost::edge_bundle, g, *edges.first).weight);
+            unsigned const vIdx = get(boost::vertex_index, g, v);
+            if (dv < dist.at(vIdx)) {
+                dist.at(vIdx) = dv;
+                pred.at(vIdx) = u;
+                relaxed.push(v);
+            }
+        }
+    }
+}
+
+// Move the failed-call self-loops of a graph read from an old archive into
+// the failed-call table. Self-loops are never on a shortest path, so the
+// archived shortest-path data still holds
+template<typename VertexProperty, typename EdgeProperty, typename VertexGeneratorType, typename EdgeGeneratorType>
+void SetuidStateGraph<VertexProperty, EdgeProperty, VertexGeneratorType, EdgeGeneratorType>::separateFailedEdges() {
+    unsigned const numVertices = boost::num_vertices(g);
+    Graph succeeded;
+    failures = FailedCallTable<EdgeProperty>(numVertices);
+    for (Vertex v = 0; v < numVertices; ++v) {
+        add_vertex(g[v], succeeded);
+    }
+    for (Vertex v = 0; v < numVertices; ++v) {
+        EdgeIteratorPair edges = boost::out_edges(v, g);
+        for (; edges.first != edges.second; ++edges.first) {
+            Vertex const u = boost::target(*edges.first, g);
+            EdgeProperty const& e = g[*edges.first];
+            if (u == v && failures.isFailure(e)) {
+                failures.add(v, e);
+            } else {
+                add_edge(v, u, e, succeeded);
+            }
+        }
+    }
+    g.swap(succeeded);
 }
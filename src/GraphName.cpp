@@ -19,6 +19,7 @@
 #include "GraphName.h"
 
 #include "Graph.h"
+#include "Util.h"
 
 #include <iostream>
 #include <utility>
@@ -61,6 +62,52 @@ GraphName::GraphName(
     name = ss.str();
 }
 
+// Parse "a_b_c" into integers
+template<typename Collection>
+static bool parseList(std::string const& str, Collection& items) {
+    std::string::size_type begin = 0;
+    while (begin <= str.size()) {
+        std::string::size_type end = str.find('_', begin);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+        try {
+            items.insert(stoi(str.substr(begin, end - begin).c_str(), NULL, 10));
+        } catch (...) {
+            return false;
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool GraphName::parse(
+    std::string const& name,
+    std::string& basename,
+    UIDSet& uidSet,
+    ParamSet& paramSet) {
+    std::string::size_type const p = name.rfind("__p_");
+    if (p == std::string::npos) {
+        return false;
+    }
+    std::string::size_type const u = name.rfind("__u_", p);
+    if (u == std::string::npos) {
+        return false;
+    }
+
+    UIDSet uids;
+    ParamSet params;
+    if (!parseList(name.substr(u + 4, p - (u + 4)), uids) ||
+        !parseList(name.substr(p + 4), params)) {
+        return false;
+    }
+
+    basename = name.substr(0, u);
+    uidSet = uids;
+    paramSet = params;
+    return true;
+}
+
 std::ostream& operator<<(std::ostream& os, GraphName const& name) {
     os << name.getName();
     return os;
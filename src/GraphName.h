@@ -27,6 +27,14 @@ public:
 
     std::string const& getName() const { return name; }
 
+    // Recover the components of a name built by the constructor; returns
+    // false if name is not of that form
+    static bool parse(
+        std::string const& name,
+        std::string& basename,
+        UIDSet& uidSet,
+        ParamSet& paramSet);
+
 private:
     std::string name;
 };
@@ -22,12 +22,17 @@
 #include "Platform.h"
 #include "Priv2State.h"
 #include "SetuidState.h"
+#include "SymmetryReduction.h"
+#include "ViolationSink.h"
 
 #include <boost/graph/breadth_first_search.hpp>
 
-#include <exception>
+#include <iosfwd>
 #include <map>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 typedef std::map<UID, UID> UIDMap;
 
@@ -108,6 +113,27 @@ private:
     Graph const& g;
 };
 
+// Lists the vertices that a breadth-first search examines, in order
+template<typename Vertex>
+class BreadthFirstOrder : public boost::default_bfs_visitor {
+public:
+    explicit BreadthFirstOrder(std::vector<Vertex>& _order) : order(_order) {}
+
+    template<typename GraphType>
+    void examine_vertex(Vertex v, GraphType&) { order.push_back(v); }
+
+private:
+    std::vector<Vertex>& order;
+};
+
+// Makes every priv2 call from each state it visits and checks the outcome.
+//
+// Calls are probed in batches, all at once (see
+// IndividualCallExplorer::exploreBatch()): those from a single state when
+// visiting it, or those from a window of states at a time in verify().
+// Results are remembered by (state, call), after mapping both to the
+// representative of their orbit when symmetry reduction is enabled, so that
+// no probe is made twice.
 template<typename Graph>
 class Priv2SanityVisitor : public SetuidStateVertexVisitor< Graph > {
 public:
@@ -128,15 +154,85 @@ public:
     Priv2SanityVisitor(Graph const& _g, CallSet const& _cs) :
         g(_g),
         callSet(_cs),
-        explorer(_g) {}
+        explorer(_g),
+        symmetry(),
+        results() {}
     virtual ~Priv2SanityVisitor() {}
 
+    // Probe one call per orbit under permutations of the UIDs other than 0
+    // and -1, deriving the outcomes of the others from it
+    void enableSymmetryReduction(UIDSet const& uids);
+
+    // Check every call from every state reachable from the start state,
+    // recording violations in s
+    void verify(ViolationSink& s);
+
     void visitVertex(VertexProperty const& v);
 
 private:
+    typedef typename Explorer::Rtn Rtn;
+    typedef std::pair<SetuidState, Priv2Call> ProbeKey;
+    typedef std::map<ProbeKey, Rtn> ResultMap;
+
+    // Files results under their keys as probes complete
+    class Collector {
+    public:
+        Collector(std::vector<ProbeKey> const& _keys, ResultMap& _results) :
+            keys(_keys), results(_results) {}
+
+        void operator()(unsigned i, Rtn const& rtn) {
+            results.insert(std::make_pair(keys.at(i), rtn));
+        }
+
+    private:
+        std::vector<ProbeKey> const& keys;
+        ResultMap& results;
+    };
+
+    // States whose calls verify() probes at once
+    static unsigned const window = 64;
+
     Graph const& g;
     CallSet const& callSet;
     Explorer explorer;
+    UIDSymmetry symmetry;
+    ResultMap results;
+    // Probes the explorer gave up on, and whether one has been reported yet;
+    // they are not made again
+    typedef std::map<ProbeKey, bool> GivenUpMap;
+    GivenUpMap givenUp;
+
+    // The probe that stands for call from v, and the relabeling r that
+    // takes call from v to it
+    ProbeKey probeKey(
+        VertexProperty const& v,
+        Priv2Call const& call,
+        UIDRelabeling& r) const;
+
+    // Probe the calls from states that have not been probed yet
+    void probe(std::vector<VertexProperty> const& states);
+};
+
+// Describes violations recorded by a Priv2SanityVisitor, making the call
+// again to show what it did
+template<typename Graph>
+class Priv2SanityDescriber : public ViolationDescriber {
+public:
+    typedef typename Graph::VertexPropertyType VertexProperty;
+    typedef typename Priv2SanityVisitor<Graph>::CallSet CallSet;
+    typedef typename Priv2SanityVisitor<Graph>::Explorer Explorer;
+
+    Priv2SanityDescriber(Graph const& _g, CallSet const& _cs) :
+        g(_g),
+        callSet(_cs),
+        explorer(_g) {}
+
+    void describe(std::ostream& os, unsigned vertex, unsigned call) const;
+
+private:
+    Graph const& g;
+    CallSet const& callSet;
+    mutable Explorer explorer;
 };
 
 #include "GraphVerificationImpl.h"
@@ -155,7 +251,7 @@ private:
             EdgeProperty const& e,                                      \
             VertexProperty const& v1,                                   \
             VertexProperty const& v2) {                                 \
-            if (e.function == _function_kind) {                         \
+            if (e.function() == _function_kind) {                       \
                 E_CONFIRM(                                              \
                     apf(e, v1, v2),                                     \
                     "Expected appropriate privileges functor: \""       \
@@ -32,7 +32,9 @@ extern "C" {
 }
 
 #include <algorithm>
+#include <iterator>
 #include <map>
+#include <ostream>
 #include <utility>
 #include <vector>
 
@@ -44,18 +46,18 @@ extern "C" {
      s.euid == INVALID_UID ||                   \
      s.svuid == INVALID_UID)
 
-// TODO: This error framework could be improved; throwing an error immediately
-// prevents subsequent checks from being performed on a vertex or edge
+// Unless cond holds, record a violation of the rule described by desc and
+// carry on with the next check. Each use site looks its rule up once.
 
-// Run in context where Graph and v are appropriately defined
-#define V_CONFIRM(cond, desc) if (!(cond)) {            \
-        throw VertexVisitorError<Graph>(desc, v);       \
+// Run in a SetuidStateVertexVisitor
+#define V_CONFIRM(cond, desc) if (!(cond)) {                            \
+        static ViolationSink::Rule const rule_ =                        \
+            ViolationSink::getRule(desc);                               \
+        this->violation(rule_);                                         \
     }
 
-// Run in context where Graph, e, v1, and v2 are appropriately defined
-#define E_CONFIRM(cond, desc) if (!(cond)) {                    \
-        throw EdgeVisitorError<Graph>(desc, e, v1, v2);        \
-    }
+// Run in a SetuidStateEdgeVisitor
+#define E_CONFIRM(cond, desc) V_CONFIRM(cond, desc)
 
 template<typename Graph>
 UIDMap Normalizer<Graph>::generateUIDMap(
@@ -117,11 +119,11 @@ SetuidFunctionCall Normalizer<Graph>::mapFunctionCall(
     UIDMap const& uidMap,
     SetuidFunctionCall const& oldSFC) {
     SetuidFunctionParams newParams;
-    for (SetuidFunctionParams::const_iterator it = oldSFC.params.begin(),
-             ie = oldSFC.params.end(); it != ie; ++it) {
+    for (SetuidFunctionParams::const_iterator it = oldSFC.params().begin(),
+             ie = oldSFC.params().end(); it != ie; ++it) {
         newParams.push_back(mapUID(uidMap, *it));
     }
-    return SetuidFunctionCall(oldSFC.function, newParams, oldSFC.rtn);
+    return SetuidFunctionCall(oldSFC.function(), newParams, oldSFC.rtn);
 }
 
 template<typename Graph>
@@ -141,42 +143,42 @@ void GeneralSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    switch (e.function) {
+    switch (e.function()) {
     default:
         E_CONFIRM(false, "Invalid setuid function type");
         break;
     case Setuid:
-        E_CONFIRM(e.params.size() == 1,
+        E_CONFIRM(e.params().size() == 1,
                   "Expected 1 parameter for setuid() call");
         break;
     case Seteuid:
-        E_CONFIRM(e.params.size() == 1,
+        E_CONFIRM(e.params().size() == 1,
                   "Expected 1 parameter for seteuid() call");
         break;
     case Setreuid:
-        E_CONFIRM(e.params.size() == 2,
+        E_CONFIRM(e.params().size() == 2,
                   "Expected 2 parameters for setreuid() call");
         break;
 
 #if HAS_SETRESUID
 
     case Setresuid:
-        E_CONFIRM(e.params.size() == 3,
+        E_CONFIRM(e.params().size() == 3,
                   "Expected 3 parameters for setresuid() call");
         break;
 
 #endif
 
     case DropPrivPerm:
-        E_CONFIRM(e.params.size() == 1,
+        E_CONFIRM(e.params().size() == 1,
                   "Expected 1 parameter for dropprivperm() call");
         break;
     case DropPrivTemp:
-        E_CONFIRM(e.params.size() == 1,
+        E_CONFIRM(e.params().size() == 1,
                   "Expected 1 parameter for dropprivtemp() call");
         break;
     case RestorePriv:
-        E_CONFIRM(e.params.size() == 1,
+        E_CONFIRM(e.params().size() == 1,
                   "Expected 1 parameter for restorepriv() call");
         break;
     }
@@ -209,9 +211,9 @@ void SetuidSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == Setuid) {
+    if (e.function() == Setuid) {
         E_CONFIRM(e.rtn.value == -1 ||
-                  v2.euid == static_cast<UID>(e.params.at(0)),
+                  v2.euid == static_cast<UID>(e.params().at(0)),
                   "Expected successful setuid() to change euid appropriately");
     }
 }
@@ -221,9 +223,9 @@ void SeteuidSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == Seteuid) {
+    if (e.function() == Seteuid) {
         E_CONFIRM(e.rtn.value == -1 ||
-                  v2.euid == static_cast<UID>(e.params.at(0)),
+                  v2.euid == static_cast<UID>(e.params().at(0)),
                   "Expected successful seteuid() to change euid appropriately");
         E_CONFIRM(v1.ruid == v2.ruid && v1.svuid == v2.svuid,
                   "Expected ruid and svuid to remain unchanged on seteuid() call");
@@ -235,16 +237,16 @@ void SetreuidSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == Setreuid) {
+    if (e.function() == Setreuid) {
         E_CONFIRM(e.rtn.value == -1 ||
-                  (e.params[0] == -1 && v1.ruid == v2.ruid) ||
-                  (e.params[0] != -1 &&
-                   v2.ruid == static_cast<UID>(e.params[0])),
+                  (e.params()[0] == -1 && v1.ruid == v2.ruid) ||
+                  (e.params()[0] != -1 &&
+                   v2.ruid == static_cast<UID>(e.params()[0])),
                   "Expected ruid to be set appropriately on setreuid() call");
         E_CONFIRM(e.rtn.value == -1 ||
-                  (e.params[1] == -1 && v1.euid == v2.euid) ||
-                  (e.params[1] != -1 &&
-                   v2.euid == static_cast<UID>(e.params[1])),
+                  (e.params()[1] == -1 && v1.euid == v2.euid) ||
+                  (e.params()[1] != -1 &&
+                   v2.euid == static_cast<UID>(e.params()[1])),
                   "Expected euid to be set appropriately on setreuid() call");
         E_CONFIRM(v1.euid != 0 || e.rtn.value == 0,
                   "Expected root to always succeed on setreuid() call");
@@ -256,21 +258,21 @@ void SetresuidSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == Setresuid) {
+    if (e.function() == Setresuid) {
         E_CONFIRM(e.rtn.value == -1 ||
-                  (e.params[0] == -1 && v1.ruid == v2.ruid) ||
-                  (e.params[0] != -1 &&
-                   v2.ruid == static_cast<UID>(e.params[0])),
+                  (e.params()[0] == -1 && v1.ruid == v2.ruid) ||
+                  (e.params()[0] != -1 &&
+                   v2.ruid == static_cast<UID>(e.params()[0])),
                   "Expected ruid to be set appropriately on setresuid() call");
         E_CONFIRM(e.rtn.value == -1 ||
-                  (e.params[1] == -1 && v1.euid == v2.euid) ||
-                  (e.params[1] != -1 &&
-                   v2.euid == static_cast<UID>(e.params[1])),
+                  (e.params()[1] == -1 && v1.euid == v2.euid) ||
+                  (e.params()[1] != -1 &&
+                   v2.euid == static_cast<UID>(e.params()[1])),
                   "Expected euid to be set appropriately on setresuid() call");
         E_CONFIRM(e.rtn.value == -1 ||
-                  (e.params[2] == -1 && v1.svuid == v2.svuid) ||
-                  (e.params[2] != -1 &&
-                   v2.svuid == static_cast<UID>(e.params[2])),
+                  (e.params()[2] == -1 && v1.svuid == v2.svuid) ||
+                  (e.params()[2] != -1 &&
+                   v2.svuid == static_cast<UID>(e.params()[2])),
                   "Expected svuid to be set appropriately on setresuid() call");
         E_CONFIRM(v1.euid != 0 || e.rtn.value == 0,
                   "Expected root to always succeed on setresuid() call");
@@ -282,10 +284,10 @@ void PrivSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == DropPrivPerm ||
-        e.function == DropPrivTemp ||
-        e.function == RestorePriv) {
-        E_CONFIRM(e.rtn.value != 0 || v2.euid == static_cast<UID>(e.params.at(0)),
+    if (e.function() == DropPrivPerm ||
+        e.function() == DropPrivTemp ||
+        e.function() == RestorePriv) {
+        E_CONFIRM(e.rtn.value != 0 || v2.euid == static_cast<UID>(e.params().at(0)),
                   "Expected successful priv function to set euid to param value");
     }
 }
@@ -295,7 +297,7 @@ void DropPrivPermSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == DropPrivPerm) {
+    if (e.function() == DropPrivPerm) {
         E_CONFIRM(e.rtn.value != 0 ||
                   (v2.ruid != 0 && v2.euid != 0 && v2.svuid != 0),
                   "Expected successful dropprivperm to eliminate root uid");
@@ -307,9 +309,9 @@ void DropPrivTempSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == DropPrivTemp) {
+    if (e.function() == DropPrivTemp) {
         E_CONFIRM(e.rtn.value != 0 ||
-                  (v2.euid == static_cast<UID>(e.params.at(0))),
+                  (v2.euid == static_cast<UID>(e.params().at(0))),
                   "Expected successful dropprivtemp to correctly set euid");
     }
 }
@@ -319,9 +321,9 @@ void RestorePrivSanityVisitor<Graph>::visitEdge(
     EdgeProperty const& e,
     VertexProperty const& v1,
     VertexProperty const& v2) {
-    if (e.function == RestorePriv) {
+    if (e.function() == RestorePriv) {
         E_CONFIRM(e.rtn.value != 0 ||
-                  (v2.euid == static_cast<UID>(e.params.at(0))),
+                  (v2.euid == static_cast<UID>(e.params().at(0))),
                   "Expected successful restorepriv to correctly set euid");
         // TODO: Confirm that no UIDs got lost in the shuffle
     }
@@ -336,8 +338,9 @@ void StartStateVisitor<Graph>::visitVertex(VertexProperty const& v) {
     if (!(v.euid == v.svuid)) {
         return;
     }
-    // Determine whether there are out-edges from this state
-    bool outEdgesExist = false;
+    // Determine whether there are out-edges from this state (failed calls
+    // count; they are self-loops)
+    bool outEdgesExist = !g.getFailedEdges(_v).empty();
     std::pair<
         typename Graph::Graph::out_edge_iterator,
         typename Graph::Graph::out_edge_iterator>
@@ -392,25 +395,128 @@ void SomewhatReversibleVisitor<Graph>::visitVertex(VertexProperty const& v) {
               "Expected to find reversible privilege escalation");
 }
 
-// TODO: This should be integrated into the error framework, rather than writing
-// directly to std::cerr
-#include <iostream>
-#define P2_CONFIRM(cond, desc)                                  \
-    if (!(cond)) {                                              \
-        std::cerr << "Priv2 verification error:" << std::endl   \
-                  << desc << std::endl                          \
-                  << "  " << *it << std::endl                   \
-                  << "    " << fnRtn << std::endl               \
-                  << "  " << v << std::endl                     \
-                  << priv2State << std::endl;                   \
+// Run in Priv2SanityVisitor::visitVertex(), where the violation is by the
+// call numbered call
+#define P2_CONFIRM(cond, desc) if (!(cond)) {                           \
+        static ViolationSink::Rule const rule_ =                        \
+            ViolationSink::getRule(desc);                               \
+        this->violation(rule_, call);                                   \
+    }
+
+template<typename Graph>
+void Priv2SanityVisitor<Graph>::enableSymmetryReduction(UIDSet const& uids) {
+    UIDSet fixed;
+    fixed.insert(0);
+    fixed.insert(static_cast<UID>(0 - 1));
+    symmetry = UIDSymmetry(uids, fixed);
+}
+
+template<typename Graph>
+void Priv2SanityVisitor<Graph>::verify(ViolationSink& s) {
+    std::vector<Vertex> order;
+    boost::breadth_first_search(
+        g.getGraph(),
+        g.getVertex(g.getStart()),
+        boost::visitor(BreadthFirstOrder<Vertex>(order)));
+
+    for (typename std::vector<Vertex>::const_iterator it = order.begin(),
+             ie = order.end(); it != ie; ) {
+        typename std::vector<Vertex>::const_iterator const windowEnd =
+            static_cast<unsigned>(ie - it) > window ? it + window : ie;
+
+        std::vector<VertexProperty> states;
+        for (typename std::vector<Vertex>::const_iterator wIt = it;
+             wIt != windowEnd; ++wIt) {
+            states.push_back(g.getGraph()[*wIt]);
+        }
+        probe(states);
+
+        // Every probe has been made, so checking a state only looks its
+        // results up
+        for (; it != windowEnd; ++it) {
+            this->checkVertex(
+                g.getGraph()[*it],
+                get(boost::vertex_index, g.getGraph(), *it),
+                s);
+        }
+    }
+}
+
+template<typename Graph>
+typename Priv2SanityVisitor<Graph>::ProbeKey
+Priv2SanityVisitor<Graph>::probeKey(
+    VertexProperty const& v,
+    Priv2Call const& call,
+    UIDRelabeling& r) const {
+    ASSERT(call.params.size() == 1);
+    r = symmetry.canonicalize(v);
+    UID const uid = call.params.at(0).uid;
+    symmetry.extend(r, SetuidFunctionParams(1, uid));
+    Priv2Call mapped(call);
+    mapped.params.at(0).uid = r.map(uid);
+    return ProbeKey(r.map(v), mapped);
+}
+
+template<typename Graph>
+void Priv2SanityVisitor<Graph>::probe(
+    std::vector<VertexProperty> const& states) {
+    std::vector<ProbeKey> keys;
+    std::set<ProbeKey> queued;
+    for (typename std::vector<VertexProperty>::const_iterator
+             sIt = states.begin(), sIe = states.end(); sIt != sIe; ++sIt) {
+        for (CallSet::const_iterator it = callSet.begin(), ie = callSet.end();
+             it != ie; ++it) {
+            UIDRelabeling r;
+            ProbeKey const key = probeKey(*sIt, *it, r);
+            if (results.find(key) == results.end() &&
+                givenUp.find(key) == givenUp.end() &&
+                queued.insert(key).second) {
+                keys.push_back(key);
+            }
+        }
+    }
+
+    // Params refer to keys, which stay put from here on
+    std::vector<typename Explorer::Param> params;
+    params.reserve(keys.size());
+    for (typename std::vector<ProbeKey>::const_iterator it = keys.begin(),
+             ie = keys.end(); it != ie; ++it) {
+        params.push_back(typename Explorer::Param(it->first, it->second));
+    }
+    Collector collector(keys, results);
+    if (explorer.exploreBatch(params, collector) != 0) {
+        for (typename std::vector<ProbeKey>::const_iterator it = keys.begin(),
+                 ie = keys.end(); it != ie; ++it) {
+            if (results.find(*it) == results.end()) {
+                givenUp.insert(std::make_pair(*it, false));
             }
+        }
+    }
+}
 
 template<typename Graph>
 void Priv2SanityVisitor<Graph>::visitVertex(VertexProperty const& v) {
+    probe(std::vector<VertexProperty>(1, v));
+
+    unsigned call = 0;
     for (CallSet::const_iterator it = callSet.begin(), ie = callSet.end();
-         it != ie; ++it) {
-        typename Explorer::Rtn rtnAndNewState =
-            explorer.exploreOne(typename Explorer::Param(v, *it));
+         it != ie; ++it, ++call) {
+        UIDRelabeling r;
+        ProbeKey const key = probeKey(v, *it, r);
+        typename ResultMap::const_iterator const result = results.find(key);
+        if (result == results.end()) {
+            // A call that kills every probe is not a sanity finding, and is
+            // reported once for its probe rather than for every state the
+            // probe stands for
+            typename GivenUpMap::iterator const gaveUp = givenUp.find(key);
+            ASSERT(gaveUp != givenUp.end());
+            P2_CONFIRM(gaveUp->second, "Explorer gave up on the probe");
+            gaveUp->second = true;
+            continue;
+        }
+        Rtn rtnAndNewState = result->second;
+        rtnAndNewState.nextState.uState =
+            r.unmap(rtnAndNewState.nextState.uState);
         Priv2FunctionReturn const& fnRtn = rtnAndNewState.fnRtn;
         Priv2State const& priv2State = rtnAndNewState.nextState;
         SetuidState const& uState = priv2State.uState;
@@ -463,10 +569,6 @@ void Priv2SanityVisitor<Graph>::visitVertex(VertexProperty const& v) {
                 {
                     sups_t param_sups = param.supGroups.toSupsT();
                     sups_t new_sups = supGroups.toSupsT();
-                    if (!eql_sups(&new_sups, &param_sups)) {
-                        print_sups("Param sups", &param_sups);
-                        print_sups("New sups", &new_sups);
-                    }
                     P2_CONFIRM(
                         eql_sups(&new_sups, &param_sups),
                         "Expected supplementary groups to change correctly on change_identity_permanently success");
@@ -496,10 +598,6 @@ void Priv2SanityVisitor<Graph>::visitVertex(VertexProperty const& v) {
                 {
                     sups_t param_sups = param.supGroups.toSupsT();
                     sups_t new_sups = supGroups.toSupsT();
-                    if (!eql_sups(&new_sups, &param_sups)) {
-                        print_sups("Param sups", &param_sups);
-                        print_sups("New sups", &new_sups);
-                    }
                     P2_CONFIRM(
                         eql_sups(&new_sups, &param_sups),
                         "Expected supplementary groups to change correctly on change_identity_temporarily success");
@@ -527,3 +625,25 @@ void Priv2SanityVisitor<Graph>::visitVertex(VertexProperty const& v) {
             "Expected uids not to change on change_identity_* failure");
     }
 }
+
+template<typename Graph>
+void Priv2SanityDescriber<Graph>::describe(
+    std::ostream& os,
+    unsigned vertex,
+    unsigned call) const {
+    VertexProperty const& v = g.getGraph()[vertex];
+    if (call == ViolationSink::noEdge) {
+        os << v;
+        return;
+    }
+    typename CallSet::const_iterator it = callSet.begin();
+    std::advance(it, call);
+    typename Explorer::Rtn rtnAndNewState;
+    if (!explorer.exploreOne(
+            typename Explorer::Param(v, *it), rtnAndNewState)) {
+        os << *it << " (no result) " << v;
+        return;
+    }
+    os << *it << " " << rtnAndNewState.fnRtn << " " << v << " -> "
+       << rtnAndNewState.nextState;
+}
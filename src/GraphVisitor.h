@@ -16,52 +16,15 @@
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
-#include <boost/graph/breadth_first_search.hpp>
-
-class GraphVisitorError : public std::exception {
-public:
-    virtual ~GraphVisitorError() throw() {}
-
-    virtual char const* what() const throw();
-
-protected:
-    std::string msg;
-};
-
-template<typename Graph>
-class VertexVisitorError : public GraphVisitorError {
-public:
-    typedef typename Graph::VertexPropertyType VertexProperty;
-
-    VertexVisitorError(
-        std::string _desc,
-        VertexProperty _v);
-
-    virtual ~VertexVisitorError() throw() {}
+#include "Assertions.h"
+#include "ViolationSink.h"
 
-    std::string const desc;
-    VertexProperty const v;
-};
-
-template<typename Graph>
-class EdgeVisitorError : public GraphVisitorError {
-public:
-    typedef typename Graph::VertexPropertyType VertexProperty;
-    typedef typename Graph::EdgePropertyType EdgeProperty;
-
-    EdgeVisitorError(
-        std::string _desc,
-        EdgeProperty _e,
-        VertexProperty _v1,
-        VertexProperty _v2);
-
-    virtual ~EdgeVisitorError() throw() {}
+#include <boost/graph/breadth_first_search.hpp>
 
-    std::string const desc;
-    EdgeProperty const e;
-    VertexProperty const v1;
-    VertexProperty const v2;
-};
+// Checks (visitors that verify a graph) report what they find with
+// E_CONFIRM()/V_CONFIRM() (see GraphVerificationImpl.h), which record
+// violations in the ViolationSink the visitor is given, against the vertex
+// or edge being visited.
 
 template<typename Graph>
 class SetuidStateEdgeVisitor : public boost::default_bfs_visitor {
@@ -70,15 +33,44 @@ public:
     typedef typename Graph::VertexPropertyType VertexProperty;
     typedef typename Graph::EdgePropertyType EdgeProperty;
 
+    SetuidStateEdgeVisitor() :
+        sink(NULL),
+        subjectVertex(0),
+        subjectEdge(ViolationSink::noEdge) {}
     virtual ~SetuidStateEdgeVisitor() {}
 
     template<typename EdgeType, typename GraphType>
     void examine_edge(EdgeType e, GraphType& g);
 
+    // A failed call at v, i.e., a self-loop that is not stored as an edge
+    void examine_failed_edge(EdgeProperty const& e, VertexProperty const& v);
+
+    // Visit one edge outside of a search: edge (numbered by the caller) of
+    // vertex, recording violations in s
+    void checkEdge(
+        EdgeProperty const& e,
+        VertexProperty const& v1,
+        VertexProperty const& v2,
+        unsigned vertex,
+        unsigned edge,
+        ViolationSink& s);
+    void checkVertex(VertexProperty const&, unsigned, ViolationSink&) {}
+
     virtual void visitEdge(
         EdgeProperty const& e,
         VertexProperty const& v1,
         VertexProperty const& v2) = 0;
+
+protected:
+    void violation(ViolationSink::Rule rule) {
+        ASSERT(sink != NULL);
+        sink->record(rule, subjectVertex, subjectEdge);
+    }
+
+private:
+    ViolationSink* sink;
+    unsigned subjectVertex;
+    unsigned subjectEdge;
 };
 
 template<typename Graph>
@@ -88,14 +80,97 @@ public:
     typedef typename Graph::VertexPropertyType VertexProperty;
     typedef typename Graph::EdgePropertyType EdgeProperty;
 
+    SetuidStateVertexVisitor() : sink(NULL), subjectVertex(0) {}
     virtual ~SetuidStateVertexVisitor() {}
 
+    // Violations found while examining vertices in a search go to s
+    void setViolationSink(ViolationSink& s) { sink = &s; }
+
     template<typename VertexType, typename GraphType>
     void examine_vertex(VertexType v, GraphType& g);
 
+    void examine_failed_edge(EdgeProperty const&, VertexProperty const&) {}
+
+    // Visit one vertex outside of a search, recording violations in s
+    void checkVertex(VertexProperty const& v, unsigned vertex, ViolationSink& s);
+    void checkEdge(
+        EdgeProperty const&,
+        VertexProperty const&,
+        VertexProperty const&,
+        unsigned,
+        unsigned,
+        ViolationSink&) {}
+
     virtual void visitVertex(VertexProperty const& v) = 0;
+
+protected:
+    void violation(ViolationSink::Rule rule) {
+        violation(rule, ViolationSink::noEdge);
+    }
+    // A violation by a call from the vertex that the check numbers itself
+    void violation(ViolationSink::Rule rule, unsigned edge) {
+        ASSERT(sink != NULL);
+        sink->record(rule, subjectVertex, edge);
+    }
+
+private:
+    ViolationSink* sink;
+    unsigned subjectVertex;
 };
 
+// Forwards breadth-first search events to a SetuidState*Visitor, handing it
+// each state's failed calls (via examine_failed_edge()) just after the state
+// is examined, so that it sees the same edges it would if failed calls were
+// stored as self-loops
+template<typename StateGraph, typename Visitor>
+class FailedEdgeVisitorAdapter {
+public:
+    FailedEdgeVisitorAdapter(StateGraph const& _graph, Visitor const& _vis) :
+        graph(_graph), vis(_vis) {}
+
+    template<typename VertexType, typename GraphType>
+    void initialize_vertex(VertexType v, GraphType& g) {
+        vis.initialize_vertex(v, g);
+    }
+    template<typename VertexType, typename GraphType>
+    void discover_vertex(VertexType v, GraphType& g) {
+        vis.discover_vertex(v, g);
+    }
+    template<typename VertexType, typename GraphType>
+    void examine_vertex(VertexType v, GraphType& g);
+    template<typename EdgeType, typename GraphType>
+    void examine_edge(EdgeType e, GraphType& g) { vis.examine_edge(e, g); }
+    template<typename EdgeType, typename GraphType>
+    void tree_edge(EdgeType e, GraphType& g) { vis.tree_edge(e, g); }
+    template<typename EdgeType, typename GraphType>
+    void non_tree_edge(EdgeType e, GraphType& g) { vis.non_tree_edge(e, g); }
+    template<typename EdgeType, typename GraphType>
+    void gray_target(EdgeType e, GraphType& g) { vis.gray_target(e, g); }
+    template<typename EdgeType, typename GraphType>
+    void black_target(EdgeType e, GraphType& g) { vis.black_target(e, g); }
+    template<typename VertexType, typename GraphType>
+    void finish_vertex(VertexType v, GraphType& g) {
+        vis.finish_vertex(v, g);
+    }
+
+private:
+    StateGraph const& graph;
+    Visitor vis;
+};
+
+// Breadth-first search of graph from start, including failed calls
+template<typename StateGraph, typename Visitor>
+void visitBreadthFirst(
+    StateGraph const& graph,
+    typename StateGraph::Vertex const& start,
+    Visitor const& vis) {
+    boost::breadth_first_search(
+        graph.getGraph(),
+        start,
+        boost::visitor(
+            FailedEdgeVisitorAdapter<StateGraph, Visitor>(graph, vis)));
+}
+
 #define BASIC_VISITOR_NAME(_type, _class_kind)          \
     template<typename Graph>                            \
     class _class_kind ## Visitor :                      \
@@ -20,70 +20,65 @@
 
 #include <boost/graph/adjacency_list.hpp>
 
-#include <iostream>
-#include <sstream>
-#include <string>
-#include <utility>
-
-char const* GraphVisitorError::what() const throw() {
-    return msg.c_str();
+template<typename Graph>
+template<typename EdgeType, typename GraphType>
+void SetuidStateEdgeVisitor<Graph>::examine_edge(
+    EdgeType e,
+    GraphType& g) {
+    Vertex v1 = source(e, g), v2 = target(e, g);
+    visitEdge(g[e], g[v1], g[v2]);
 }
 
 template<typename Graph>
-VertexVisitorError<Graph>::VertexVisitorError(
-    std::string _desc,
-    VertexProperty _v) :
-    desc(_desc), v(_v) {
-    std::stringstream ss;
-    ss << desc << std::endl;
-    ss << "  " << v << std::endl;
-    msg = ss.str();
+void SetuidStateEdgeVisitor<Graph>::examine_failed_edge(
+    EdgeProperty const& e,
+    VertexProperty const& v) {
+    visitEdge(e, v, v);
 }
 
 template<typename Graph>
-EdgeVisitorError<Graph>::EdgeVisitorError(
-    std::string _desc,
-    EdgeProperty _e,
-    VertexProperty _v1,
-    VertexProperty _v2) :
-    desc(_desc), e(_e), v1(_v1), v2(_v2) {
-    std::stringstream ss;
-    ss << desc << std::endl;
-    ss << "  " << e << std::endl;
-    ss << "  " << v1 << std::endl;
-    ss << "  " << v2 << std::endl;
-    msg = ss.str();
+void SetuidStateEdgeVisitor<Graph>::checkEdge(
+    EdgeProperty const& e,
+    VertexProperty const& v1,
+    VertexProperty const& v2,
+    unsigned vertex,
+    unsigned edge,
+    ViolationSink& s) {
+    sink = &s;
+    subjectVertex = vertex;
+    subjectEdge = edge;
+    visitEdge(e, v1, v2);
 }
 
 template<typename Graph>
-template<typename EdgeType, typename GraphType>
-void SetuidStateEdgeVisitor<Graph>::examine_edge(
-    EdgeType e,
+template<typename VertexType, typename GraphType>
+void SetuidStateVertexVisitor<Graph>::examine_vertex(
+    VertexType v,
     GraphType& g) {
-    Vertex v1 = source(e, g), v2 = target(e, g);
-    try {
-        visitEdge(g[e], g[v1], g[v2]);
-    } catch (EdgeVisitorError<Graph>& gve) {
-        std::cerr << "Graph visitor error:" << std::endl;
-
-        std::string empty("");
-
-        ASSERT(empty != gve.what());
-
-        std::cerr << gve.what() << std::endl;
-    }
+    subjectVertex = get(boost::vertex_index, g, v);
+    visitVertex(g[v]);
 }
 
 template<typename Graph>
+void SetuidStateVertexVisitor<Graph>::checkVertex(
+    VertexProperty const& v,
+    unsigned vertex,
+    ViolationSink& s) {
+    sink = &s;
+    subjectVertex = vertex;
+    visitVertex(v);
+}
+
+template<typename StateGraph, typename Visitor>
 template<typename VertexType, typename GraphType>
-void SetuidStateVertexVisitor<Graph>::examine_vertex(
+void FailedEdgeVisitorAdapter<StateGraph, Visitor>::examine_vertex(
     VertexType v,
     GraphType& g) {
-    try {
-        visitVertex(g[v]);
-    } catch (VertexVisitorError<Graph>& gve) {
-        std::cerr << "Graph visitor error:" << std::endl;
-        ASSERT(std::string("") != gve.what());
-        std::cerr << gve.what() << std::endl;
+    vis.examine_vertex(v, g);
+    typename StateGraph::EdgePropertyList const failed =
+        graph.getFailedEdges(v);
+    for (typename StateGraph::EdgePropertyList::const_iterator
+             it = failed.begin(), ie = failed.end(); it != ie; ++it) {
+        vis.examine_failed_edge(*it, g[v]);
     }
 }
@@ -21,7 +21,6 @@
 
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/graph/adj_list_serialize.hpp>
-#include <boost/graph/graphviz.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/vector.hpp>
 
@@ -47,10 +46,42 @@ void DotWriter<Graph>::write(
     std::ofstream ofsg(
         std::string(name.getName() + ".dot").c_str(),
         std::ofstream::out);
-    typename Graph::Graph const& boostGraph = graph.getGraph();
-    LabelWriter<typename Graph::Graph> lwriter(boostGraph);
-    GraphWriter gwriter;
-    boost::write_graphviz(ofsg, boostGraph, lwriter, lwriter, gwriter);
+    typedef typename Graph::Graph BoostGraph;
+    BoostGraph const& boostGraph = graph.getGraph();
+    LabelWriter<BoostGraph> lwriter(boostGraph);
+
+    // Laid out as write_graphviz() would, followed by each state's failed
+    // calls, which the graph does not hold as edges, as self-loops
+    ofsg << "digraph G {" << std::endl;
+    GraphWriter()(ofsg);
+    typename boost::graph_traits<BoostGraph>::vertex_iterator vi, ve;
+    for (boost::tie(vi, ve) = boost::vertices(boostGraph); vi != ve; ++vi) {
+        ofsg << get(boost::vertex_index, boostGraph, *vi);
+        lwriter(ofsg, *vi);
+        ofsg << ";" << std::endl;
+    }
+    typename boost::graph_traits<BoostGraph>::edge_iterator ei, ee;
+    for (boost::tie(ei, ee) = boost::edges(boostGraph); ei != ee; ++ei) {
+        ofsg << get(boost::vertex_index, boostGraph,
+                    boost::source(*ei, boostGraph))
+             << "->"
+             << get(boost::vertex_index, boostGraph,
+                    boost::target(*ei, boostGraph))
+             << " ";
+        lwriter(ofsg, *ei);
+        ofsg << ";" << std::endl;
+    }
+    for (boost::tie(vi, ve) = boost::vertices(boostGraph); vi != ve; ++vi) {
+        typename Graph::EdgePropertyList const failed =
+            graph.getFailedEdges(*vi);
+        unsigned const v = get(boost::vertex_index, boostGraph, *vi);
+        for (typename Graph::EdgePropertyList::const_iterator
+                 it = failed.begin(), ie = failed.end(); it != ie; ++it) {
+            ofsg << v << "->" << v << " [label=\"" << *it << "\"];"
+                 << std::endl;
+        }
+    }
+    ofsg << "}" << std::endl;
 }
 
 #ifndef U2P
@@ -72,10 +103,10 @@ void CSVWriterVisitor<Graph>::visitEdge(
     static int const missingValue = -99;
     unsigned count;
     os << U2P(v1.ruid) << "," << U2P(v1.euid) << "," << U2P(v1.svuid) << ",\""
-       << e.function << "\",";
+       << e.function() << "\",";
     count = 0;
-    for (SetuidFunctionParams::const_iterator it = e.params.begin(),
-             ie = e.params.end(); it != ie; ++it) {
+    for (SetuidFunctionParams::const_iterator it = e.params().begin(),
+             ie = e.params().end(); it != ie; ++it) {
         os << *it << ",";
         ++count;
     }
@@ -88,8 +119,8 @@ void CSVWriterVisitor<Graph>::visitEdge(
     os << CP(v1.ruid, 0) << ","
        << CP(v1.euid, 0) << ","
        << CP(v1.svuid, 0) << ",";
-    for (SetuidFunctionParams::const_iterator it = e.params.begin(),
-             ie = e.params.end(); it != ie; ++it) {
+    for (SetuidFunctionParams::const_iterator it = e.params().begin(),
+             ie = e.params().end(); it != ie; ++it) {
         os << CP(v1.ruid, *it) << ","
            << CP(v1.euid, *it) << ","
            << CP(v1.svuid, *it) << ",";
@@ -118,11 +149,10 @@ void CSVWriter<Graph>::write(
     std::ofstream ofs(
         std::string(name + ".csv").c_str(),
         std::ofstream::out);
-    boost::breadth_first_search(
-        graph.getGraph(),
+    visitBreadthFirst(
+        graph,
         graph.getVertex(graph.getStart()),
-        boost::visitor(
-            CSVWriterVisitor<Graph>(
-                graph,
-                ofs)));
+        CSVWriterVisitor<Graph>(
+            graph,
+            ofs));
 }
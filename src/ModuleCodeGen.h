@@ -19,6 +19,8 @@
 #include "Assertions.h"
 #include "CodeGen.h"
 #include "Graph.h"
+#include "PredecessorMatrix.h"
+#include "ReachabilityIndex.h"
 #include "SetuidState.h"
 #include "VisitorAccumulator.h"
 
@@ -66,6 +68,7 @@ public:
         uidPtrPtrGenArrayType(uidPtrPtrGenType.getArrayType()),
         adjacencyCode(NULL),
         predecessorCode(NULL),
+        reachabilityCode(NULL),
         effectivePrivStatesCode(NULL),
         privJumpCode(NULL) {
 
@@ -75,13 +78,16 @@ public:
         generateCalls();
         generateCallLists();
         generateAdjMatrix();
+        flattenGraph();
         generatePredecessors();
+        generateReachability();
         generatePrivJumps();
     }
 
     virtual ~ModuleGenerator() {
         delete adjacencyCode;
         delete predecessorCode;
+        delete reachabilityCode;
         delete effectivePrivStatesCode;
         delete privJumpCode;
     }
@@ -120,7 +126,9 @@ public:
         os << "#define MAX_NORMALIZED_IDS "
            << numNormalUnprivilegedUIDs << std::endl
            << "#define NEG_ONE_IS_SUPPORTED "
-           << negOneIsSupported << std::endl;
+           << negOneIsSupported << std::endl
+           << "#define REACHABILITY_WORD_BITS "
+           << ReachabilityIndex::packedWordBits << std::endl;
 
         os << std::endl << "/** Globals **/" << std::endl << std::endl;
 
@@ -128,6 +136,8 @@ public:
         os << adjacencyCode->defn();
         ASSERT(predecessorCode);
         os << predecessorCode->defn();
+        ASSERT(reachabilityCode);
+        os << reachabilityCode->defn();
         ASSERT(effectivePrivStatesCode);
         os << effectivePrivStatesCode->defn();
         ASSERT(privJumpCode);
@@ -212,6 +222,12 @@ public:
         ASSERT(predecessorCode);
         os << *predecessorCode;
 
+        os << std::endl << "/** Reachability matrix **/" << std::endl
+           << std::endl;
+
+        ASSERT(reachabilityCode);
+        os << *reachabilityCode;
+
         os << std::endl << "/** Effective privileged states **/" << std::endl
            << std::endl;
 
@@ -267,12 +283,20 @@ private:
     std::string executeGroupFunctionName;
 
     VertexList states;
+    // Index into states of each graph vertex, or -1 for vertices that are
+    // not reachable from the start
+    std::vector<int> stateIdx;
+    // The graph restricted to states, as flat adjacency lists over indices
+    // into states
+    PredecessorMatrix::IndexList successorOffsets;
+    PredecessorMatrix::IndexList successors;
     EdgeList calls;
     StateMap stateCode;
     CallMap callCode;
     CallSetMap callSetCode;
     AdjacencyMatrixGenerator* adjacencyCode;
     PredecessorMatrixGenerator* predecessorCode;
+    ReachabilityMatrixGenerator* reachabilityCode;
     StateListGenerator* effectivePrivStatesCode;
     PrivJumpGenerator* privJumpCode;
 
@@ -328,6 +352,11 @@ private:
             }
         }
         std::sort(states.begin(), states.end());
+        stateIdx.assign(boost::num_vertices(g.getGraph()), -1);
+        for (unsigned i = 0; i < states.size(); ++i) {
+            stateIdx.at(boost::get(boost::vertex_index, g.getGraph(),
+                                   g.getVertex(states[i]))) = i;
+        }
 
         NameList effectiveName;
         effectiveName.push_back("effective");
@@ -423,21 +452,38 @@ private:
         adjacencyCode = new AdjacencyMatrixGenerator(ng, uidPtrPtrGenArrayType, items);
     }
 
+    // Every edge out of a state reachable from the start leads to another
+    // one, so the flattened graph is closed
+    void flattenGraph() {
+        typename Graph::Graph const& boostGraph = g.getGraph();
+        successorOffsets.clear();
+        successors.clear();
+        for (typename VertexList::const_iterator it = states.begin(),
+                 ie = states.end(); it != ie; ++it) {
+            successorOffsets.push_back(successors.size());
+            std::pair<
+                typename Graph::Graph::out_edge_iterator,
+                typename Graph::Graph::out_edge_iterator>
+                i = boost::out_edges(g.getVertex(*it), boostGraph);
+            for (; i.first != i.second; ++i.first) {
+                int const targetIdx =
+                    getVertexStateIdx(boost::target(*i.first, boostGraph));
+                ASSERT(targetIdx >= 0);
+                successors.push_back(targetIdx);
+            }
+        }
+        successorOffsets.push_back(successors.size());
+    }
+
     void generatePredecessors() {
-        unsigned const dimSize = states.size();
+        typedef PredecessorMatrix::Index Index;
+
+        PredecessorMatrix const predecessors(successorOffsets, successors);
         PredecessorMatrixGenerator::ItemList items;
-        for (typename VertexList::const_iterator it1 = states.begin(),
-                 ie1 = states.end(); it1 != ie1; ++it1) {
+        for (Index source = 0; source < predecessors.size(); ++source) {
             PredecessorMatrixGenerator::Item::ItemList innerList;
-            Graph const newGraph(g, *it1);
-
-            for (typename VertexList::const_iterator it2 = states.begin(),
-                     ie2 = states.end(); it2 != ie2; ++it2) {
-                SetuidState const& predecessor = newGraph.getPredecessor(*it2);
-                int predecessorIdx = getStateIdx(predecessor);
-                ASSERT(predecessorIdx >= 0 &&
-                       static_cast<unsigned>(predecessorIdx) < dimSize);
-                innerList.push_back(predecessorIdx);
+            for (Index target = 0; target < predecessors.size(); ++target) {
+                innerList.push_back(predecessors.get(source, target));
             }
             items.push_back(
                 InlineArrayConstGenerator<unsigned>(
@@ -451,6 +497,27 @@ private:
             items);
     }
 
+    void generateReachability() {
+        typedef ReachabilityIndex::Index Index;
+
+        ReachabilityIndex const reachability(successorOffsets, successors);
+        ReachabilityMatrixGenerator::ItemList items;
+        for (Index source = 0; source < reachability.size(); ++source) {
+            ReachabilityIndex::PackedRow const row =
+                reachability.getPackedRow(source);
+            items.push_back(
+                InlineArrayConstGenerator<unsigned>(
+                    unsignedType,
+                    ReachabilityMatrixGenerator::Item::ItemList(
+                        row.begin(),
+                        row.end())));
+        }
+        reachabilityCode = new ReachabilityMatrixGenerator(
+            ng,
+            unsignedArrayType,
+            items);
+    }
+
     void generatePrivJumps() {
         // Generate jumps
         VertexEdgeAccumulator<Graph> accumulator;
@@ -538,16 +605,12 @@ private:
     }
 
     int getStateIdx(SetuidState const& state) const {
-        typename VertexList::const_iterator it = std::find(
-            states.begin(),
-            states.end(),
-            state);
-        if (it == states.end()) {
-            return -1;
-        } else {
-            ASSERT(it - states.begin() >= 0);
-            return it - states.begin();
-        }
+        return getVertexStateIdx(g.getVertex(state));
+    }
+
+    int getVertexStateIdx(typename Graph::Vertex const& v) const {
+        return stateIdx.at(
+            boost::get(boost::vertex_index, g.getGraph(), v));
     }
 
     std::ostream& streamGetNumFunctionParams(std::ostream& os) const {
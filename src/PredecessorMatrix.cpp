@@ -0,0 +1,101 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "PredecessorMatrix.h"
+
+#include "Assertions.h"
+
+#include <algorithm>
+
+#ifdef MULTITHREADED
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+PredecessorMatrix::PredecessorMatrix(
+    IndexList const& _offsets,
+    IndexList const& _targets) :
+    offsets(_offsets),
+    targets(_targets),
+    numStates(_offsets.size() - 1),
+    matrix(numStates * numStates),
+    nextSource(0) {
+    ASSERT(!offsets.empty() && offsets.back() == targets.size());
+
+#ifdef MULTITHREADED
+    long const numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned const numThreads = numCPUs > 1 ? numCPUs - 1 : 0;
+    std::vector<pthread_t> threads;
+    for (unsigned i = 0; i < numThreads; ++i) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, computeRows, this) != 0) {
+            break;
+        }
+        threads.push_back(thread);
+    }
+    // This thread takes rows too, so the work gets done even if no thread
+    // could be started
+    computeRows();
+    for (std::vector<pthread_t>::const_iterator it = threads.begin(),
+             ie = threads.end(); it != ie; ++it) {
+        pthread_join(*it, NULL);
+    }
+#else
+    computeRows();
+#endif
+}
+
+void PredecessorMatrix::computeRows() {
+    IndexList queue(numStates);
+    for (Index source = __sync_fetch_and_add(&nextSource, 1);
+         source < numStates;
+         source = __sync_fetch_and_add(&nextSource, 1)) {
+        computeRow(source, queue);
+    }
+}
+
+void* PredecessorMatrix::computeRows(void* pm) {
+    static_cast<PredecessorMatrix*>(pm)->computeRows();
+    return NULL;
+}
+
+// Breadth-first search from source; every state is queued at most once, so
+// queue needs no more than numStates slots
+void PredecessorMatrix::computeRow(Index source, IndexList& queue) {
+    static Index const unvisited = static_cast<Index>(-1);
+    Index* const row = &matrix[source * numStates];
+    std::fill(row, row + numStates, unvisited);
+    row[source] = source;
+
+    unsigned head = 0, tail = 0;
+    queue[tail++] = source;
+    while (head < tail) {
+        Index const u = queue[head++];
+        for (Index i = offsets[u], ie = offsets[u + 1]; i < ie; ++i) {
+            Index const v = targets[i];
+            if (row[v] == unvisited) {
+                row[v] = u;
+                queue[tail++] = v;
+            }
+        }
+    }
+
+    for (Index v = 0; v < numStates; ++v) {
+        if (row[v] == unvisited) {
+            row[v] = v;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <vector>
+
+// Shortest-path predecessors between every pair of states of a graph whose
+// edges all have unit weight.
+//
+// The graph is given as flat adjacency lists over state indices (the
+// successors of state i are targets[offsets[i]] up to, but excluding,
+// targets[offsets[i + 1]]), and each row of the matrix is filled by one
+// breadth-first search from its source. As with a single-source search,
+// a source is its own predecessor, and so is every state it cannot reach.
+// Built with MULTITHREADED, rows are computed by one thread per online
+// processor.
+class PredecessorMatrix {
+public:
+    typedef unsigned Index;
+    typedef std::vector<Index> IndexList;
+
+    PredecessorMatrix(IndexList const& offsets, IndexList const& targets);
+
+    unsigned size() const { return numStates; }
+
+    // The predecessor of target on a shortest path from source
+    Index get(Index source, Index target) const {
+        return matrix[source * numStates + target];
+    }
+
+private:
+    // Only read while the matrix is being built
+    IndexList const& offsets;
+    IndexList const& targets;
+    unsigned const numStates;
+    IndexList matrix;
+    // Next row to be computed, shared by all threads
+    Index nextSource;
+
+    void computeRows();
+    void computeRow(Index source, IndexList& queue);
+
+    static void* computeRows(void* pm);
+};
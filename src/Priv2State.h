@@ -350,8 +350,8 @@ struct Priv2Call {
         }
         free(param.sups.list);
         Priv2FunctionReturn rtn = success == 0 ?
-            Priv2FunctionReturn(success, 0, "") :
-            Priv2FunctionReturn(success, errno, std::strerror(errno));
+            Priv2FunctionReturn(success, 0) :
+            Priv2FunctionReturn(success, errno);
         return rtn;
     }
 
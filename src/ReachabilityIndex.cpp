@@ -0,0 +1,77 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "ReachabilityIndex.h"
+
+#include "Assertions.h"
+
+unsigned const ReachabilityIndex::packedWordBits;
+unsigned const ReachabilityIndex::wordBits;
+
+ReachabilityIndex::ReachabilityIndex(
+    IndexList const& offsets,
+    IndexList const& targets) :
+    numStates(offsets.size() - 1),
+    wordsPerRow((numStates + wordBits - 1) / wordBits),
+    matrix(numStates * wordsPerRow, 0) {
+    ASSERT(!offsets.empty() && offsets.back() == targets.size());
+
+    for (Index i = 0; i < numStates; ++i) {
+        Word* const row = getRow(i);
+        row[i / wordBits] |= Word(1) << (i % wordBits);
+        for (Index j = offsets[i], je = offsets[i + 1]; j < je; ++j) {
+            row[targets[j] / wordBits] |= Word(1) << (targets[j] % wordBits);
+        }
+    }
+
+    // The inner loop is a plain OR over contiguous words, which compilers
+    // vectorize
+    for (Index k = 0; k < numStates; ++k) {
+        Word const* const rowK = getRow(k);
+        Index const kWord = k / wordBits;
+        Word const kBit = Word(1) << (k % wordBits);
+        for (Index i = 0; i < numStates; ++i) {
+            Word* const rowI = getRow(i);
+            if (i == k || !(rowI[kWord] & kBit)) {
+                continue;
+            }
+            for (unsigned w = 0; w < wordsPerRow; ++w) {
+                rowI[w] |= rowK[w];
+            }
+        }
+    }
+}
+
+bool ReachabilityIndex::reachesAny(Index source, Word const* targets) const {
+    Word const* const row = getRow(source);
+    for (unsigned w = 0; w < wordsPerRow; ++w) {
+        if (row[w] & targets[w]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ReachabilityIndex::PackedRow ReachabilityIndex::getPackedRow(
+    Index source) const {
+    PackedRow packed(getPackedWordsPerRow(), 0);
+    for (Index target = 0; target < numStates; ++target) {
+        if (canReach(source, target)) {
+            packed[target / packedWordBits] |= 1u << (target % packedWordBits);
+        }
+    }
+    return packed;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+// Which states can reach which: a V x V bit matrix, closed under paths of
+// any length (including the empty path, so every state reaches itself).
+//
+// The graph is given as flat adjacency lists over state indices, as for
+// PredecessorMatrix. The closure is Warshall's algorithm over rows of
+// machine words: whenever state i reaches k, all of k's row is OR-ed into
+// i's, one word at a time.
+class ReachabilityIndex {
+public:
+    typedef unsigned Index;
+    typedef std::vector<Index> IndexList;
+    typedef uint64_t Word;
+
+    // Rows exported for generated C code are made of unsigned ints of this
+    // many bits
+    static unsigned const packedWordBits = 32;
+    typedef std::vector<unsigned> PackedRow;
+
+    ReachabilityIndex(IndexList const& offsets, IndexList const& targets);
+
+    unsigned size() const { return numStates; }
+
+    bool canReach(Index source, Index target) const {
+        return (getRow(source)[target / wordBits] >> (target % wordBits)) & 1;
+    }
+
+    // Whether source reaches any state whose bit is set in targets (a row of
+    // wordsPerRow words)
+    bool reachesAny(Index source, Word const* targets) const;
+
+    Word const* getRow(Index source) const {
+        return &matrix[source * wordsPerRow];
+    }
+    unsigned getWordsPerRow() const { return wordsPerRow; }
+
+    PackedRow getPackedRow(Index source) const;
+    unsigned getPackedWordsPerRow() const {
+        return (numStates + packedWordBits - 1) / packedWordBits;
+    }
+
+private:
+    static unsigned const wordBits = 64;
+
+    unsigned const numStates;
+    unsigned const wordsPerRow;
+    std::vector<Word> matrix;
+
+    Word* getRow(Index source) { return &matrix[source * wordsPerRow]; }
+};
@@ -0,0 +1,176 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "ResultArena.h"
+
+#include "Assertions.h"
+#include "Platform.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if IS_LINUX
+
+#include <sys/eventfd.h>
+
+#endif
+
+#include <cstring>
+
+struct ResultArena::SlotHeader {
+    volatile uint32_t status;
+    uint32_t size;
+};
+
+ResultArena::ResultArena() :
+    numSlots(0),
+    slotCapacity(0),
+    slotStride(0),
+    mappedSize(0),
+    memory(NULL),
+    notifyRead(-1),
+    notifyWrite(-1) {}
+
+ResultArena::~ResultArena() {
+    if (memory != NULL) {
+        munmap(memory, mappedSize);
+    }
+    if (notifyRead != -1) {
+        close(notifyRead);
+    }
+    if (notifyWrite != -1 && notifyWrite != notifyRead) {
+        close(notifyWrite);
+    }
+}
+
+bool ResultArena::create(unsigned _numSlots, size_t _slotCapacity) {
+    ASSERT(memory == NULL);
+
+    // Keep headers aligned
+    size_t const align = sizeof(uint64_t);
+    slotStride = (sizeof(SlotHeader) + _slotCapacity + align - 1) / align * align;
+    mappedSize = slotStride * _numSlots;
+
+    void* const shared = mmap(
+        NULL,
+        mappedSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANON,
+        -1,
+        0);
+    if (shared == MAP_FAILED) {
+        return false;
+    }
+
+#if IS_LINUX
+
+    notifyRead = notifyWrite = eventfd(0, EFD_NONBLOCK);
+    if (notifyRead == -1) {
+        int const error = errno;
+        munmap(shared, mappedSize);
+        errno = error;
+        return false;
+    }
+
+#else
+
+    FileDescriptor fd[2];
+    if (pipe(fd) == -1) {
+        int const error = errno;
+        munmap(shared, mappedSize);
+        errno = error;
+        return false;
+    }
+    notifyRead = fd[0];
+    notifyWrite = fd[1];
+    fcntl(notifyRead, F_SETFL, fcntl(notifyRead, F_GETFL) | O_NONBLOCK);
+    fcntl(notifyWrite, F_SETFL, fcntl(notifyWrite, F_GETFL) | O_NONBLOCK);
+
+#endif
+
+    memory = static_cast<char*>(shared);
+    numSlots = _numSlots;
+    slotCapacity = _slotCapacity;
+    for (unsigned i = 0; i < numSlots; ++i) {
+        clear(i);
+    }
+    return true;
+}
+
+ResultArena::SlotHeader* ResultArena::header(unsigned slot) const {
+    ASSERT(slot < numSlots);
+    return reinterpret_cast<SlotHeader*>(memory + slot * slotStride);
+}
+
+void ResultArena::publish(unsigned slot, std::string const& payload) {
+    SlotHeader* const h = header(slot);
+    if (payload.size() > slotCapacity) {
+        h->size = 0;
+        __sync_synchronize();
+        h->status = SlotOverflow;
+    } else {
+        std::memcpy(reinterpret_cast<char*>(h + 1), payload.data(),
+                    payload.size());
+        h->size = payload.size();
+        // The payload must be visible before the status that announces it
+        __sync_synchronize();
+        h->status = SlotComplete;
+    }
+
+#if IS_LINUX
+
+    uint64_t const one = 1;
+
+#else
+
+    char const one = 1;
+
+#endif
+
+    // Fails with EAGAIN only if notifications are already waiting
+    while (write(notifyWrite, &one, sizeof(one)) == -1 && errno == EINTR) {}
+}
+
+void ResultArena::drain() {
+    char buffer[64];
+    for (;;) {
+        ssize_t const numRead = ::read(notifyRead, buffer, sizeof(buffer));
+        if (numRead <= 0 && !(numRead == -1 && errno == EINTR)) {
+            break;
+        }
+    }
+}
+
+ResultArena::SlotStatus ResultArena::getStatus(unsigned slot) const {
+    SlotStatus const status = static_cast<SlotStatus>(header(slot)->status);
+    __sync_synchronize();
+    return status;
+}
+
+std::string ResultArena::read(unsigned slot) const {
+    SlotHeader const* const h = header(slot);
+    ASSERT(h->status == SlotComplete);
+    return std::string(reinterpret_cast<char const*>(h + 1), h->size);
+}
+
+void ResultArena::clear(unsigned slot) {
+    SlotHeader* const h = header(slot);
+    h->size = 0;
+    h->status = SlotPending;
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "Channel.h"
+
+#include <stddef.h>
+
+#include <string>
+
+// Fixed-size result slots in memory shared with forked children. The
+// parent creates the arena before forking and hands each child a slot; the
+// child copies its (encoded) result into the slot, marks it complete and
+// pokes a single notifier descriptor that the parent can poll. However many
+// children are in flight, the arena costs two descriptors (one on Linux,
+// where the notifier is an eventfd).
+class ResultArena {
+public:
+    enum SlotStatus {
+        SlotPending,
+        SlotComplete,
+        // The result did not fit; the slot holds nothing
+        SlotOverflow,
+    };
+
+    ResultArena();
+    ~ResultArena();
+
+    // Returns false (with errno set) if the arena cannot be mapped
+    bool create(unsigned numSlots, size_t slotCapacity);
+
+    unsigned getNumSlots() const { return numSlots; }
+    size_t getSlotCapacity() const { return slotCapacity; }
+
+    // Readable whenever some child has published since the last drain()
+    FileDescriptor getNotifier() const { return notifyRead; }
+
+    // Child side: store payload in slot and notify the parent
+    void publish(unsigned slot, std::string const& payload);
+
+    // Parent side
+    void drain();
+    SlotStatus getStatus(unsigned slot) const;
+    // Copy out a complete slot's payload
+    std::string read(unsigned slot) const;
+    // Make slot available to the next child
+    void clear(unsigned slot);
+
+private:
+    struct SlotHeader;
+
+    unsigned numSlots;
+    size_t slotCapacity;
+    size_t slotStride;
+    size_t mappedSize;
+    char* memory;
+    FileDescriptor notifyRead;
+    FileDescriptor notifyWrite;
+
+    SlotHeader* header(unsigned slot) const;
+
+    // Not copyable: children inherit the mapping itself
+    ResultArena(ResultArena const&);
+    ResultArena& operator=(ResultArena const&);
+};
@@ -0,0 +1,586 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "RuleSet.h"
+
+#include "SetuidState.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+typedef EdgeTable::Value Value;
+
+unsigned const chunkSize = EdgeTable::chunkSize;
+
+struct ColumnName {
+    char const* name;
+    EdgeTable::ColumnId id;
+};
+
+ColumnName const columnNames[] = {
+    { "pre.ruid", EdgeTable::PreRuid },
+    { "pre.euid", EdgeTable::PreEuid },
+    { "pre.svuid", EdgeTable::PreSvuid },
+    { "post.ruid", EdgeTable::PostRuid },
+    { "post.euid", EdgeTable::PostEuid },
+    { "post.svuid", EdgeTable::PostSvuid },
+    { "function", EdgeTable::Function },
+    { "param1", EdgeTable::Param1 },
+    { "param2", EdgeTable::Param2 },
+    { "param3", EdgeTable::Param3 },
+    { "return", EdgeTable::Return },
+    { "errno", EdgeTable::Errno },
+};
+
+struct ConstantName {
+    char const* name;
+    Value value;
+};
+
+ConstantName const errnoNames[] = {
+    { "EPERM", EPERM },
+    { "EINVAL", EINVAL },
+    { "EAGAIN", EAGAIN },
+};
+
+template<typename T, unsigned n>
+unsigned lengthOf(T const (&)[n]) {
+    return n;
+}
+
+bool lookupFunction(std::string const& name, Value& value) {
+    SetuidFunction const functions[] = {
+        Setuid, Seteuid, Setreuid, Setresuid,
+        DropPrivPerm, DropPrivTemp, RestorePriv,
+    };
+    for (unsigned i = 0; i < lengthOf(functions); ++i) {
+        std::ostringstream os;
+        os << functions[i];
+        if (os.str() == name) {
+            value = functions[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+// The loops over a chunk. Registers written are never read by the same
+// instruction, so dst aliases neither source; saying so lets the loops
+// vectorize without a run-time overlap check
+
+template<typename Compare>
+void compareColumns(
+    Value const* __restrict__ a,
+    Value const* __restrict__ b,
+    unsigned char* __restrict__ dst) {
+    Compare const compare = Compare();
+    for (unsigned i = 0; i < chunkSize; ++i) {
+        dst[i] = compare(a[i], b[i]);
+    }
+}
+
+template<typename Compare>
+void compareConstant(
+    Value const* __restrict__ a,
+    Value const b,
+    unsigned char* __restrict__ dst) {
+    Compare const compare = Compare();
+    for (unsigned i = 0; i < chunkSize; ++i) {
+        dst[i] = compare(a[i], b);
+    }
+}
+
+struct AndFlags {
+    unsigned char operator()(unsigned char a, unsigned char b) const {
+        return a & b;
+    }
+};
+
+struct OrFlags {
+    unsigned char operator()(unsigned char a, unsigned char b) const {
+        return a | b;
+    }
+};
+
+struct NotFlags {
+    unsigned char operator()(unsigned char a, unsigned char) const {
+        return a ^ 1;
+    }
+};
+
+struct ImpliesFlags {
+    unsigned char operator()(unsigned char a, unsigned char b) const {
+        return (a ^ 1) | b;
+    }
+};
+
+template<typename Combine>
+void combine(
+    unsigned char const* __restrict__ a,
+    unsigned char const* __restrict__ b,
+    unsigned char* __restrict__ dst) {
+    Combine const op = Combine();
+    for (unsigned i = 0; i < chunkSize; ++i) {
+        dst[i] = op(a[i], b[i]);
+    }
+}
+
+} // namespace
+
+// Recursive descent over one rule's expression, emitting an instruction per
+// comparison and combinator into a fresh register
+class RuleSet::Compiler {
+public:
+    // Compiles the expression at text[start..]
+    Compiler(
+        std::string const& _text,
+        std::string::size_type start,
+        Rule& _rule) :
+        text(_text),
+        pos(start),
+        rule(_rule) {}
+
+    bool compile(std::string& error);
+
+private:
+    struct Operand {
+        bool isColumn;
+        EdgeTable::ColumnId column;
+        Value constant;
+    };
+
+    std::string const& text;
+    std::string::size_type pos;
+    Rule& rule;
+    std::string problem;
+
+    bool implication(unsigned& reg);
+    bool disjunction(unsigned& reg);
+    bool conjunction(unsigned& reg);
+    bool negation(unsigned& reg);
+    bool comparison(unsigned& reg);
+    bool operand(Operand& op);
+
+    void skipSpace();
+    bool accept(char const* token);
+    bool fail(std::string const& expected);
+    unsigned emit(Opcode opcode, unsigned a, unsigned b);
+};
+
+bool RuleSet::Compiler::compile(std::string& error) {
+    rule.code.clear();
+    rule.numRegisters = 0;
+    if (!implication(rule.result)) {
+        error = problem;
+        return false;
+    }
+    skipSpace();
+    if (pos != text.size()) {
+        fail("an operator");
+        error = problem;
+        return false;
+    }
+    return true;
+}
+
+bool RuleSet::Compiler::implication(unsigned& reg) {
+    if (!disjunction(reg)) {
+        return false;
+    }
+    if (accept("->")) {
+        unsigned rhs;
+        if (!implication(rhs)) {
+            return false;
+        }
+        reg = emit(Implies, reg, rhs);
+    }
+    return true;
+}
+
+bool RuleSet::Compiler::disjunction(unsigned& reg) {
+    if (!conjunction(reg)) {
+        return false;
+    }
+    while (accept("||")) {
+        unsigned rhs;
+        if (!conjunction(rhs)) {
+            return false;
+        }
+        reg = emit(Or, reg, rhs);
+    }
+    return true;
+}
+
+bool RuleSet::Compiler::conjunction(unsigned& reg) {
+    if (!negation(reg)) {
+        return false;
+    }
+    while (accept("&&")) {
+        unsigned rhs;
+        if (!negation(rhs)) {
+            return false;
+        }
+        reg = emit(And, reg, rhs);
+    }
+    return true;
+}
+
+bool RuleSet::Compiler::negation(unsigned& reg) {
+    if (accept("!")) {
+        if (!negation(reg)) {
+            return false;
+        }
+        reg = emit(Not, reg, reg);
+        return true;
+    }
+    if (accept("(")) {
+        if (!implication(reg)) {
+            return false;
+        }
+        return accept(")") || fail("\")\"");
+    }
+    return comparison(reg);
+}
+
+bool RuleSet::Compiler::comparison(unsigned& reg) {
+    Operand lhs;
+    if (!operand(lhs)) {
+        return false;
+    }
+
+    // Longer tokens first, so that "<=" is not read as "<"
+    Comparison cmp;
+    if (accept("==")) {
+        cmp = Equal;
+    } else if (accept("!=")) {
+        cmp = NotEqual;
+    } else if (accept("<=")) {
+        cmp = LessEqual;
+    } else if (accept(">=")) {
+        cmp = GreaterEqual;
+    } else if (accept("<")) {
+        cmp = Less;
+    } else if (accept(">")) {
+        cmp = Greater;
+    } else {
+        return fail("a comparison");
+    }
+
+    Operand rhs;
+    if (!operand(rhs)) {
+        return false;
+    }
+
+    // Keep the column on the left: c < x is x > c
+    if (!lhs.isColumn && rhs.isColumn) {
+        std::swap(lhs, rhs);
+        switch (cmp) {
+        case Less: cmp = Greater; break;
+        case LessEqual: cmp = GreaterEqual; break;
+        case Greater: cmp = Less; break;
+        case GreaterEqual: cmp = LessEqual; break;
+        default: break;
+        }
+    }
+
+    Instruction inst;
+    inst.comparison = cmp;
+    inst.dst = rule.numRegisters++;
+    inst.a = lhs.column;
+    inst.b = rhs.column;
+    inst.constant = rhs.constant;
+    if (lhs.isColumn && rhs.isColumn) {
+        inst.opcode = CompareColumns;
+    } else if (lhs.isColumn) {
+        inst.opcode = CompareConstant;
+    } else {
+        Value const a = lhs.constant;
+        Value const b = rhs.constant;
+        bool value = false;
+        switch (cmp) {
+        case Equal: value = a == b; break;
+        case NotEqual: value = a != b; break;
+        case Less: value = a < b; break;
+        case LessEqual: value = a <= b; break;
+        case Greater: value = a > b; break;
+        case GreaterEqual: value = a >= b; break;
+        }
+        inst.opcode = Fill;
+        inst.constant = value;
+    }
+    rule.code.push_back(inst);
+    reg = inst.dst;
+    return true;
+}
+
+bool RuleSet::Compiler::operand(Operand& op) {
+    skipSpace();
+    op.isColumn = false;
+    op.column = EdgeTable::NumColumns;
+    op.constant = 0;
+
+    std::string::size_type const start = pos;
+    if (pos < text.size() &&
+        (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+         (text[pos] == '-' && pos + 1 < text.size() &&
+          std::isdigit(static_cast<unsigned char>(text[pos + 1]))))) {
+        ++pos;
+        while (pos < text.size() &&
+               std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        errno = 0;
+        long const l = strtol(text.substr(start, pos - start).c_str(), NULL, 10);
+        if (errno == ERANGE ||
+            l < std::numeric_limits<Value>::min() ||
+            l > std::numeric_limits<Value>::max()) {
+            pos = start;
+            return fail("a 32-bit integer");
+        }
+        op.constant = static_cast<Value>(l);
+        return true;
+    }
+
+    while (pos < text.size() && isIdentifierChar(text[pos])) {
+        ++pos;
+    }
+    std::string const name = text.substr(start, pos - start);
+    for (unsigned i = 0; i < lengthOf(columnNames); ++i) {
+        if (name == columnNames[i].name) {
+            op.isColumn = true;
+            op.column = columnNames[i].id;
+            return true;
+        }
+    }
+    for (unsigned i = 0; i < lengthOf(errnoNames); ++i) {
+        if (name == errnoNames[i].name) {
+            op.constant = errnoNames[i].value;
+            return true;
+        }
+    }
+    if (lookupFunction(name, op.constant)) {
+        return true;
+    }
+    pos = start;
+    return fail("a column, function, errno name or integer");
+}
+
+void RuleSet::Compiler::skipSpace() {
+    while (pos < text.size() &&
+           std::isspace(static_cast<unsigned char>(text[pos]))) {
+        ++pos;
+    }
+}
+
+bool RuleSet::Compiler::accept(char const* token) {
+    skipSpace();
+    std::string::size_type const length = std::char_traits<char>::length(token);
+    if (text.compare(pos, length, token) != 0) {
+        return false;
+    }
+    pos += length;
+    return true;
+}
+
+bool RuleSet::Compiler::fail(std::string const& expected) {
+    std::ostringstream os;
+    os << "column " << pos + 1 << ": expected " << expected;
+    problem = os.str();
+    return false;
+}
+
+unsigned RuleSet::Compiler::emit(Opcode opcode, unsigned a, unsigned b) {
+    Instruction inst;
+    inst.opcode = opcode;
+    inst.comparison = Equal;
+    inst.dst = rule.numRegisters++;
+    inst.a = a;
+    inst.b = b;
+    inst.constant = 0;
+    rule.code.push_back(inst);
+    return inst.dst;
+}
+
+bool RuleSet::parse(std::istream& is, std::string& error) {
+    std::string line;
+    for (unsigned lineNumber = 1; std::getline(is, line); ++lineNumber) {
+        std::string::size_type const first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        // Expressions have no colons, so the last one ends the description
+        std::string::size_type const colon = line.rfind(':');
+        std::string description;
+        std::string::size_type expression;
+        if (colon == std::string::npos) {
+            description = line.substr(first);
+            expression = first;
+        } else {
+            description = line.substr(first, colon - first);
+            expression = colon + 1;
+        }
+        std::string::size_type const last =
+            description.find_last_not_of(" \t\r");
+        description.erase(last == std::string::npos ? 0 : last + 1);
+
+        Rule rule;
+        std::string problem;
+        if (!Compiler(line, expression, rule).compile(problem)) {
+            std::ostringstream os;
+            os << "line " << lineNumber << ": " << problem;
+            error = os.str();
+            return false;
+        }
+        rule.rule = ViolationSink::getRule(description.c_str());
+        rules.push_back(rule);
+    }
+    return true;
+}
+
+void RuleSet::check(EdgeTable const& table, ViolationSink& sink) const {
+    unsigned numRegisters = 0;
+    for (std::vector<Rule>::const_iterator it = rules.begin(),
+             ie = rules.end(); it != ie; ++it) {
+        numRegisters = std::max(numRegisters, it->numRegisters);
+    }
+    std::vector<unsigned char> registers(numRegisters * chunkSize);
+
+    std::vector<unsigned> const& vertices = table.getVertices();
+    std::vector<unsigned> const& edges = table.getEdges();
+    unsigned const size = table.size();
+    for (unsigned first = 0; first < size; first += chunkSize) {
+        unsigned const count = std::min(chunkSize, size - first);
+        for (std::vector<Rule>::const_iterator it = rules.begin(),
+                 ie = rules.end(); it != ie; ++it) {
+            for (std::vector<Instruction>::const_iterator
+                     ii = it->code.begin(), iie = it->code.end();
+                 ii != iie; ++ii) {
+                run(*ii, table, first, &registers[0]);
+            }
+            unsigned char const* result = &registers[it->result * chunkSize];
+            for (unsigned i = 0; i < count; ++i) {
+                if (!result[i]) {
+                    sink.record(
+                        it->rule, vertices[first + i], edges[first + i]);
+                }
+            }
+        }
+    }
+}
+
+void RuleSet::run(
+    Instruction const& inst,
+    EdgeTable const& table,
+    unsigned first,
+    unsigned char* registers) {
+    unsigned char* const dst = registers + inst.dst * chunkSize;
+    switch (inst.opcode) {
+    case CompareColumns: {
+        Value const* const a =
+            &table.getColumn(static_cast<EdgeTable::ColumnId>(inst.a))[first];
+        Value const* const b =
+            &table.getColumn(static_cast<EdgeTable::ColumnId>(inst.b))[first];
+        switch (inst.comparison) {
+        case Equal:
+            compareColumns< std::equal_to<Value> >(a, b, dst);
+            break;
+        case NotEqual:
+            compareColumns< std::not_equal_to<Value> >(a, b, dst);
+            break;
+        case Less:
+            compareColumns< std::less<Value> >(a, b, dst);
+            break;
+        case LessEqual:
+            compareColumns< std::less_equal<Value> >(a, b, dst);
+            break;
+        case Greater:
+            compareColumns< std::greater<Value> >(a, b, dst);
+            break;
+        case GreaterEqual:
+            compareColumns< std::greater_equal<Value> >(a, b, dst);
+            break;
+        }
+        break;
+    }
+    case CompareConstant: {
+        Value const* const a =
+            &table.getColumn(static_cast<EdgeTable::ColumnId>(inst.a))[first];
+        Value const b = inst.constant;
+        switch (inst.comparison) {
+        case Equal:
+            compareConstant< std::equal_to<Value> >(a, b, dst);
+            break;
+        case NotEqual:
+            compareConstant< std::not_equal_to<Value> >(a, b, dst);
+            break;
+        case Less:
+            compareConstant< std::less<Value> >(a, b, dst);
+            break;
+        case LessEqual:
+            compareConstant< std::less_equal<Value> >(a, b, dst);
+            break;
+        case Greater:
+            compareConstant< std::greater<Value> >(a, b, dst);
+            break;
+        case GreaterEqual:
+            compareConstant< std::greater_equal<Value> >(a, b, dst);
+            break;
+        }
+        break;
+    }
+    case Fill:
+        std::fill(
+            dst, dst + chunkSize, static_cast<unsigned char>(inst.constant));
+        break;
+    case And:
+        combine<AndFlags>(
+            registers + inst.a * chunkSize,
+            registers + inst.b * chunkSize,
+            dst);
+        break;
+    case Or:
+        combine<OrFlags>(
+            registers + inst.a * chunkSize,
+            registers + inst.b * chunkSize,
+            dst);
+        break;
+    case Not:
+        combine<NotFlags>(
+            registers + inst.a * chunkSize,
+            registers + inst.a * chunkSize,
+            dst);
+        break;
+    case Implies:
+        combine<ImpliesFlags>(
+            registers + inst.a * chunkSize,
+            registers + inst.b * chunkSize,
+            dst);
+        break;
+    }
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "EdgeTable.h"
+#include "ViolationSink.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// Conformance rules over an EdgeTable, read at run time so that a new rule
+// does not need a new visitor class and a rebuild.
+//
+// A rules file holds one rule per line: a description, a colon, then an
+// expression that must hold for every edge. Blank lines and lines starting
+// with '#' are skipped; a line without a colon is its own description. E.g.:
+//   setuid() success sets euid: function == setuid && return == 0 -> post.euid == param1
+//
+// Expressions, from loosest to tightest binding:
+//   a -> b                      (implication, right-associative)
+//   a || b
+//   a && b
+//   !a   (a)
+//   x == y   x != y   x < y   x <= y   x > y   x >= y
+// where x and y are columns (pre.ruid, pre.euid, pre.svuid, post.ruid,
+// post.euid, post.svuid, function, param1, param2, param3, return, errno),
+// integers, function names (setuid, seteuid, setreuid, setresuid,
+// dropprivperm, dropprivtemp, restorepriv) or errno names (EPERM, EINVAL,
+// EAGAIN).
+//
+// Each rule is compiled to instructions over registers of
+// EdgeTable::chunkSize flags. Rows are checked a chunk at a time; every
+// instruction is one fixed-length loop over the chunk's column values or
+// flags, which the compiler can vectorize. A row
+// for which a rule is false is recorded as a violation of the rule against
+// the row's vertex and edge.
+class RuleSet {
+public:
+    // Adds the rules in is. Returns false, with the line and problem in
+    // error, if a rule is malformed; rules before it are kept
+    bool parse(std::istream& is, std::string& error);
+
+    unsigned size() const { return rules.size(); }
+
+    void check(EdgeTable const& table, ViolationSink& sink) const;
+
+private:
+    class Compiler;
+    friend class Compiler;
+
+    enum Opcode {
+        // Compare columns a and b
+        CompareColumns,
+        // Compare column a with constant
+        CompareConstant,
+        // Set every flag to constant
+        Fill,
+        // Combine registers a and b (Not only reads a)
+        And,
+        Or,
+        Not,
+        Implies,
+    };
+
+    enum Comparison {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+    };
+
+    struct Instruction {
+        Opcode opcode;
+        Comparison comparison;
+        unsigned dst;
+        unsigned a;
+        unsigned b;
+        EdgeTable::Value constant;
+    };
+
+    struct Rule {
+        ViolationSink::Rule rule;
+        std::vector<Instruction> code;
+        unsigned numRegisters;
+        // Register holding the rule's value once code has run
+        unsigned result;
+    };
+
+    std::vector<Rule> rules;
+
+    static void run(
+        Instruction const& inst,
+        EdgeTable const& table,
+        unsigned first,
+        unsigned char* registers);
+};
@@ -29,7 +29,10 @@
 
 #include <cstring>
 #include <fstream>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #if IS_SOLARIS
 
@@ -144,6 +147,15 @@ std::ostream& operator<<(std::ostream& os, SetuidState const& ss) {
     return os;
 }
 
+std::string SetuidFunctionReturn::errDescription() const {
+    if (errNumber == 0) {
+        return "";
+    } else if (errNumber < 0) {
+        return "Function return object uninitialized";
+    }
+    return std::strerror(errNumber);
+}
+
 std::ostream& operator<<(std::ostream& os, SetuidFunctionReturn const& sfr) {
     os << ": " << sfr.value;
     if (sfr.value != 0) {
@@ -179,6 +191,70 @@ std::ostream& operator<<(std::ostream& os, SetuidFunctionParams const& sfp) {
 }
 
 std::ostream& operator<<(std::ostream& os, SetuidFunctionCall const& sfc) {
-    os << sfc.function << sfc.params << sfc.rtn;
+    os << sfc.function() << sfc.params() << sfc.rtn;
     return os;
 }
+
+namespace {
+
+typedef std::pair<SetuidFunction, SetuidFunctionParams> InternedCall;
+typedef std::map<InternedCall, SetuidCallId> InternedCallMap;
+
+// Calls are stored once, as keys of ids; map nodes never move, so calls can
+// index them by id and references handed out by getParams() stay valid
+struct InternedCalls {
+    InternedCalls() {
+        InternedCall const invalid(SetuidInvalid, SetuidFunctionParams());
+        calls.push_back(&ids.insert(std::make_pair(invalid, 0)).first->first);
+    }
+
+    InternedCallMap ids;
+    std::vector<InternedCall const*> calls;
+};
+
+InternedCalls& internedCalls() {
+    static InternedCalls table;
+    return table;
+}
+
+InternedCall const& getInternedCall(SetuidCallId id) {
+    InternedCalls const& table = internedCalls();
+    ASSERT(id < table.calls.size());
+    return *table.calls[id];
+}
+
+}
+
+SetuidCallId const SetuidCallTable::invalidCall = 0;
+
+SetuidCallId SetuidCallTable::intern(
+    SetuidFunction function,
+    SetuidFunctionParams const& params) {
+    InternedCalls& table = internedCalls();
+    std::pair<InternedCallMap::iterator, bool> const inserted =
+        table.ids.insert(std::make_pair(InternedCall(function, params),
+                                        table.calls.size()));
+    if (inserted.second) {
+        table.calls.push_back(&inserted.first->first);
+    }
+    return inserted.first->second;
+}
+
+SetuidFunction SetuidCallTable::getFunction(SetuidCallId id) {
+    return getInternedCall(id).first;
+}
+
+SetuidFunctionParams const& SetuidCallTable::getParams(SetuidCallId id) {
+    return getInternedCall(id).second;
+}
+
+bool SetuidCallTable::less(SetuidCallId id1, SetuidCallId id2) {
+    InternedCall const& c1 = getInternedCall(id1);
+    InternedCall const& c2 = getInternedCall(id2);
+    return ((static_cast<int>(c1.first) < static_cast<int>(c2.first)) ||
+            (c1.first == c2.first && c1.second < c2.second));
+}
+
+unsigned SetuidCallTable::size() {
+    return internedCalls().calls.size();
+}
@@ -100,6 +100,8 @@ private:
 };
 std::ostream& operator<<(std::ostream& os, SetuidState const& ss);
 
+// Only the return value and errno are stored; the error description is
+// derived from errno when it is asked for
 struct SetuidFunctionReturn {
     template<
         typename VertexProperty,
@@ -109,14 +111,10 @@ struct SetuidFunctionReturn {
     friend class SetuidStateGraph;
     friend class boost::serialization::access;
 
-    int value;
-    int errNumber;
-    std::string errDescription;
+    short value;
+    short errNumber;
 
-    SetuidFunctionReturn(SetuidFunctionReturn const& r) :
-        value(r.value),
-        errNumber(r.errNumber),
-        errDescription(r.errDescription) {}
+    std::string errDescription() const;
 
     // static SetuidFunctionReturn parse(std::string const& str);
 
@@ -132,19 +130,20 @@ struct SetuidFunctionReturn {
     // TODO: These should be private, but some code requires "auto-construction"
     SetuidFunctionReturn() :
         value(-1),
-        errNumber(-1),
-        errDescription("Function return object uninitialized") {}
-    SetuidFunctionReturn(int _value, int _errNumber, std::string _errDescription) :
+        errNumber(-1) {}
+    SetuidFunctionReturn(int _value, int _errNumber) :
         value(_value),
-        errNumber(_errNumber),
-        errDescription(_errDescription) {}
+        errNumber(_errNumber) {}
 
 private:
+    // The description is still archived, so that archives read the same as
+    // they did when it was stored
     template<class Archive>
     void serialize(Archive& ar, unsigned int const version) {
+        std::string description = errDescription();
         ar & value;
         ar & errNumber;
-        ar & errDescription;
+        ar & description;
     }
 };
 std::ostream& operator<<(std::ostream& os, SetuidFunctionReturn const& sfr);
@@ -153,49 +152,82 @@ std::ostream& operator<<(std::ostream& os, SetuidFunctionReturn const& sfr);
 typedef std::vector<SetuidFunctionParam> SetuidFunctionParams;
 std::ostream& operator<<(std::ostream& os, SetuidFunctionParams const& sfp);
 
+typedef unsigned SetuidCallId;
+
+// Interns (function, params) pairs: every distinct call a process sees is
+// stored once, and edges refer to it by id. Ids are local to a process (and
+// its forked children), so calls are archived and sent between processes by
+// value
+class SetuidCallTable {
+public:
+    // The id of SetuidFunctionCall()'s call: (SetuidInvalid, ())
+    static SetuidCallId const invalidCall;
+
+    static SetuidCallId intern(
+        SetuidFunction function,
+        SetuidFunctionParams const& params);
+
+    static SetuidFunction getFunction(SetuidCallId id);
+    static SetuidFunctionParams const& getParams(SetuidCallId id);
+
+    // Orders ids the way (function, params) pairs are ordered
+    static bool less(SetuidCallId id1, SetuidCallId id2);
+
+    static unsigned size();
+};
+
 struct SetuidFunctionCall {
     friend class boost::serialization::access;
 
     // TODO: These should be private, but some code requires "auto-construction"
-    SetuidFunctionCall() : function(SetuidInvalid), params(), rtn(), weight(0) {}
+    SetuidFunctionCall() :
+        call(SetuidCallTable::invalidCall),
+        rtn(),
+        weight(0) {}
 
     SetuidFunctionCall(
         SetuidFunction _function,
-        SetuidFunctionParams _params,
+        SetuidFunctionParams const& _params,
         SetuidFunctionReturn _rtn) :
-        function(_function),
-        params(_params),
+        call(SetuidCallTable::intern(_function, _params)),
         rtn(_rtn),
         weight(1) {}
 
-    SetuidFunction function;
-    SetuidFunctionParams params;
+    SetuidCallId call;
     SetuidFunctionReturn rtn;
     // TODO: This should be const, but that breaks some container magic
     unsigned weight;
 
+    SetuidFunction function() const {
+        return SetuidCallTable::getFunction(call);
+    }
+    SetuidFunctionParams const& params() const {
+        return SetuidCallTable::getParams(call);
+    }
+    void setParams(SetuidFunctionParams const& _params) {
+        call = SetuidCallTable::intern(function(), _params);
+    }
+
     bool operator<(SetuidFunctionCall const& sfc) const {
-        return ((static_cast<int>(function) < static_cast<int>(sfc.function)) ||
-                (static_cast<int>(function) == static_cast<int>(sfc.function) &&
-                 params < sfc.params) ||
-                (static_cast<int>(function) == static_cast<int>(sfc.function) &&
-                 params == sfc.params && rtn < sfc.rtn) ||
-                (static_cast<int>(function) == static_cast<int>(sfc.function) &&
-                 params == sfc.params && rtn == sfc.rtn &&
-                 weight < sfc.weight));
+        return ((call != sfc.call && SetuidCallTable::less(call, sfc.call)) ||
+                (call == sfc.call && rtn < sfc.rtn) ||
+                (call == sfc.call && rtn == sfc.rtn && weight < sfc.weight));
     }
     bool operator==(SetuidFunctionCall const& sfc) const {
-        return (static_cast<int>(function) == static_cast<int>(sfc.function) &&
-                 params == sfc.params && rtn == sfc.rtn &&
-                 weight == sfc.weight);
+        return (call == sfc.call && rtn == sfc.rtn && weight == sfc.weight);
     }
 
 private:
     template<class Archive>
     void serialize(Archive& ar, unsigned int const version) {
-        ar & function;
-        ar & params;
+        SetuidFunction _function = function();
+        SetuidFunctionParams _params = params();
+        ar & _function;
+        ar & _params;
         ar & rtn;
+        if (Archive::is_loading::value) {
+            call = SetuidCallTable::intern(_function, _params);
+        }
     }
 };
 std::ostream& operator<<(std::ostream& os, SetuidFunctionCall const& sf);
@@ -0,0 +1,63 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "StreamingNormalizer.h"
+
+#include "Assertions.h"
+
+#include <algorithm>
+
+UID const UIDTable::unmapped;
+unsigned const UIDTable::maxTableSize;
+
+UIDTable::UIDTable(UIDMap const& _uidMap) :
+    uidMap(_uidMap),
+    base(0),
+    table() {
+    bool found = false;
+    UID lo = 0;
+    UID hi = 0;
+    for (UIDMap::const_iterator it = uidMap.begin(), ie = uidMap.end();
+         it != ie; ++it) {
+        if (static_cast<int>(it->first) < 0) {
+            continue;
+        }
+        lo = found ? std::min(lo, it->first) : it->first;
+        hi = found ? std::max(hi, it->first) : it->first;
+        found = true;
+    }
+    if (!found || hi - lo >= maxTableSize) {
+        return;
+    }
+
+    base = lo;
+    table.assign(hi - lo + 1, unmapped);
+    for (UIDMap::const_iterator it = uidMap.begin(), ie = uidMap.end();
+         it != ie; ++it) {
+        if (static_cast<int>(it->first) >= 0) {
+            ASSERT(it->second != unmapped);
+            table[it->first - base] = it->second;
+        }
+    }
+}
+
+UID UIDTable::mapSparse(UID uid) const {
+    UIDMap::const_iterator const mapping = uidMap.find(uid);
+    ASSERT(mapping != uidMap.end());
+    return mapping->second;
+}
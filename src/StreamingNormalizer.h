@@ -0,0 +1,161 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "Graph.h"
+#include "GraphName.h"
+#include "GraphVerification.h"
+#include "GraphWriter.h"
+#include "SetuidState.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/tracking.hpp>
+#include <boost/serialization/version.hpp>
+
+// A UIDMap as a table indexed by UID, for mapping every UID of an archive.
+// UIDs that are negative as ints (such as -1) are far from the others, so
+// they (and every UID, if the rest are spread too far apart) are looked up
+// in the map instead.
+class UIDTable {
+public:
+    explicit UIDTable(UIDMap const& _uidMap);
+
+    UID map(UID uid) const {
+        if (uid - base < table.size() && table[uid - base] != unmapped) {
+            return table[uid - base];
+        }
+        return mapSparse(uid);
+    }
+
+private:
+    // No UID in the table maps to -1: only -1 does, and it is not in it
+    static UID const unmapped = static_cast<UID>(-1);
+    static unsigned const maxTableSize = 1 << 20;
+
+    UIDMap const uidMap;
+    UID base;
+    std::vector<UID> table;
+
+    UID mapSparse(UID uid) const;
+};
+
+// Normalizes an archived graph (see Normalizer) without loading it.
+//
+// Relabeling UIDs maps states and calls one-to-one, so the normalized graph
+// has the same vertices, in the same order, and the same edges: the archive
+// is read one vertex or edge at a time, and each is relabeled (through a
+// UIDTable) and written out, along with its line of the graphviz file,
+// before the next is read. Shortest-path data carries over unchanged. Only
+// the states (to index them once all are read) and the failed-call table
+// are held in memory. Archives that store failed calls as self-loops
+// (version 0) are read twice: first to count the self-loops, which are not
+// written as edges, then to normalize.
+template<typename Graph>
+class StreamingNormalizer {
+public:
+    typedef typename Graph::VertexPropertyType VertexProperty;
+    typedef typename Graph::EdgePropertyType EdgeProperty;
+
+    explicit StreamingNormalizer(UIDSet const& uids) :
+        uidMap(Normalizer<Graph>::generateUIDMap(uids)),
+        uidTable(uidMap) {}
+
+    UIDSet getUIDSet() const {
+        return Normalizer<Graph>::generateUIDSet(uidMap);
+    }
+
+    // Write the normalized form of the archive inName as an archive and a
+    // graphviz file named outName; false if there is no such archive
+    bool normalize(GraphName const& inName, GraphName const& outName) const;
+
+    VertexProperty mapState(VertexProperty const& s) const;
+    EdgeProperty mapFunctionCall(EdgeProperty const& e) const;
+
+private:
+    // Relabels the calls of a failed-call table
+    struct CallMapper {
+        explicit CallMapper(StreamingNormalizer const& _n) : n(_n) {}
+
+        EdgeProperty operator()(EdgeProperty const& e) const {
+            return n.mapFunctionCall(e);
+        }
+
+        StreamingNormalizer const& n;
+    };
+
+    UIDMap const uidMap;
+    UIDTable const uidTable;
+
+    // The failed calls stored as self-loops in the version 0 archive at path
+    unsigned countFailedLoops(std::string const& path) const;
+};
+
+// Stand-ins that serialize as the class information of a SetuidStateGraph,
+// and of its boost graph's vertex and edge counts: an archive of a graph can
+// then be read or written one field at a time, just as the graph would have
+// been
+template<typename Graph>
+struct GraphArchiveHeader {
+    GraphArchiveHeader() : version(0) {}
+
+    unsigned version;
+
+    template<class Archive>
+    void serialize(Archive&, unsigned int const _version) {
+        version = _version;
+    }
+};
+
+template<typename BoostGraph>
+struct BoostGraphArchiveHeader {
+    BoostGraphArchiveHeader() : numVertices(0), numEdges(0) {}
+
+    int numVertices;
+    int numEdges;
+
+    template<class Archive>
+    void serialize(Archive& ar, unsigned int const version) {
+        ar & numVertices;
+        ar & numEdges;
+    }
+};
+
+namespace boost { namespace serialization {
+template<typename Graph>
+struct version< GraphArchiveHeader<Graph> > : version<Graph> {};
+template<typename Graph>
+struct tracking_level< GraphArchiveHeader<Graph> > : tracking_level<Graph> {};
+template<typename Graph>
+struct implementation_level< GraphArchiveHeader<Graph> > :
+        implementation_level<Graph> {};
+
+template<typename BoostGraph>
+struct version< BoostGraphArchiveHeader<BoostGraph> > : version<BoostGraph> {};
+template<typename BoostGraph>
+struct tracking_level< BoostGraphArchiveHeader<BoostGraph> > :
+        tracking_level<BoostGraph> {};
+template<typename BoostGraph>
+struct implementation_level< BoostGraphArchiveHeader<BoostGraph> > :
+        implementation_level<BoostGraph> {};
+} }
+
+#include "StreamingNormalizerImpl.h"
@@ -0,0 +1,203 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "Assertions.h"
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/graph/adj_list_serialize.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+template<typename Graph>
+bool StreamingNormalizer<Graph>::normalize(
+    GraphName const& inName,
+    GraphName const& outName) const {
+    typedef typename Graph::Graph BoostGraph;
+    typedef typename Graph::Vertex Vertex;
+
+    std::string const inPath = inName.getName() + ".archive";
+    std::ifstream ifsa(inPath.c_str(), std::ifstream::in);
+    if (!ifsa) {
+        std::cerr << "ERROR: Cannot open \"" << inPath << "\"" << std::endl;
+        return false;
+    }
+    boost::archive::text_iarchive ia(ifsa);
+
+    // The fields below are those of SetuidStateGraph::serialize(), and of
+    // boost's adjacency_list serialization within it, in order
+    GraphArchiveHeader<Graph> inHeader;
+    ia >> inHeader;
+    bool const failedLoops = inHeader.version == 0;
+    unsigned const numFailedLoops =
+        failedLoops ? countFailedLoops(inPath) : 0;
+
+    std::ofstream ofsa(
+        std::string(outName.getName() + ".archive").c_str(),
+        std::ofstream::out);
+    std::ofstream ofsg(
+        std::string(outName.getName() + ".dot").c_str(),
+        std::ofstream::out);
+    boost::archive::text_oarchive oa(ofsa);
+
+    GraphArchiveHeader<Graph> const outHeader;
+    oa << outHeader;
+
+    BoostGraphArchiveHeader<BoostGraph> counts;
+    ia >> counts;
+    BoostGraphArchiveHeader<BoostGraph> outCounts(counts);
+    outCounts.numEdges -= numFailedLoops;
+    oa << outCounts;
+    FailedCallTable<EdgeProperty> failures(
+        failedLoops ? counts.numVertices : 0);
+
+    // Laid out as DotWriter lays it out, failed calls last
+    ofsg << "digraph G {" << std::endl;
+    GraphWriter()(ofsg);
+
+    std::vector<VertexProperty> states;
+    states.reserve(counts.numVertices);
+    for (int i = 0; i < counts.numVertices; ++i) {
+        VertexProperty v;
+        ia >> v;
+        VertexProperty const mapped = mapState(v);
+        oa << mapped;
+        ofsg << i << "[label=\"" << mapped << "\"];" << std::endl;
+        states.push_back(mapped);
+    }
+
+    for (int i = 0; i < counts.numEdges; ++i) {
+        int u;
+        int v;
+        EdgeProperty e;
+        ia >> u >> v >> e;
+        EdgeProperty const mapped = mapFunctionCall(e);
+        if (failedLoops && u == v && failures.isFailure(mapped)) {
+            failures.add(u, mapped);
+            continue;
+        }
+        oa << u << v << mapped;
+        ofsg << u << "->" << v << " [label=\"" << mapped << "\"];"
+             << std::endl;
+    }
+
+    typename BoostGraph::graph_property_type graphProperty;
+    ia >> graphProperty;
+    oa << graphProperty;
+
+    VertexProperty start;
+    ia >> start;
+    VertexProperty const mappedStart = mapState(start);
+    oa << mappedStart;
+
+    // Vertices and edges keep their order, so shortest paths do too
+    typename Graph::PredecessorList pred;
+    ia >> pred;
+    oa << pred;
+    typename Graph::DistanceList dist;
+    ia >> dist;
+    oa << dist;
+
+    // Relabeled states sort differently; index them afresh
+    {
+        typename Graph::VertexPropertyMap vPropMap;
+        ia >> vPropMap;
+    }
+    typename Graph::VertexPropertyMap mappedVPropMap;
+    for (unsigned i = 0; i < states.size(); ++i) {
+        mappedVPropMap.insert(
+            std::make_pair(states[i], static_cast<Vertex>(i)));
+    }
+    states.clear();
+    oa << mappedVPropMap;
+
+    if (!failedLoops) {
+        ia >> failures;
+        failures.mapCalls(CallMapper(*this));
+    }
+    oa << failures;
+
+    for (unsigned i = 0; i < failures.getNumVertices(); ++i) {
+        typename FailedCallTable<EdgeProperty>::EdgePropertyList const
+            failed = failures.get(i);
+        for (typename FailedCallTable<EdgeProperty>::EdgePropertyList::
+                 const_iterator it = failed.begin(), ie = failed.end();
+             it != ie; ++it) {
+            ofsg << i << "->" << i << " [label=\"" << *it << "\"];"
+                 << std::endl;
+        }
+    }
+    ofsg << "}" << std::endl;
+
+    return true;
+}
+
+template<typename Graph>
+unsigned StreamingNormalizer<Graph>::countFailedLoops(
+    std::string const& path) const {
+    typedef typename Graph::Graph BoostGraph;
+
+    std::ifstream ifsa(path.c_str(), std::ifstream::in);
+    boost::archive::text_iarchive ia(ifsa);
+    GraphArchiveHeader<Graph> header;
+    ia >> header;
+    BoostGraphArchiveHeader<BoostGraph> counts;
+    ia >> counts;
+    for (int i = 0; i < counts.numVertices; ++i) {
+        VertexProperty v;
+        ia >> v;
+    }
+    unsigned numFailed = 0;
+    for (int i = 0; i < counts.numEdges; ++i) {
+        int u;
+        int v;
+        EdgeProperty e;
+        ia >> u >> v >> e;
+        if (u == v && FailedCallTable<EdgeProperty>::isFailure(e)) {
+            ++numFailed;
+        }
+    }
+    return numFailed;
+}
+
+template<typename Graph>
+typename StreamingNormalizer<Graph>::VertexProperty
+StreamingNormalizer<Graph>::mapState(VertexProperty const& s) const {
+    return VertexProperty(
+        uidTable.map(s.ruid),
+        uidTable.map(s.euid),
+        uidTable.map(s.svuid));
+}
+
+template<typename Graph>
+typename StreamingNormalizer<Graph>::EdgeProperty
+StreamingNormalizer<Graph>::mapFunctionCall(EdgeProperty const& e) const {
+    SetuidFunctionParams newParams;
+    for (SetuidFunctionParams::const_iterator it = e.params().begin(),
+             ie = e.params().end(); it != ie; ++it) {
+        newParams.push_back(uidTable.map(*it));
+    }
+    return EdgeProperty(e.function(), newParams, e.rtn);
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "SymmetryReduction.h"
+
+#include "Assertions.h"
+
+#include <algorithm>
+
+UID UIDRelabeling::map(UID uid) const {
+    UIDMap::const_iterator it = forward.find(uid);
+    return it == forward.end() ? uid : it->second;
+}
+
+UID UIDRelabeling::unmap(UID uid) const {
+    UIDMap::const_iterator it = backward.find(uid);
+    return it == backward.end() ? uid : it->second;
+}
+
+SetuidState UIDRelabeling::map(SetuidState const& ss) const {
+    return SetuidState(map(ss.ruid), map(ss.euid), map(ss.svuid));
+}
+
+SetuidState UIDRelabeling::unmap(SetuidState const& ss) const {
+    return SetuidState(unmap(ss.ruid), unmap(ss.euid), unmap(ss.svuid));
+}
+
+SetuidFunctionParams UIDRelabeling::map(
+    SetuidFunctionParams const& params) const {
+    SetuidFunctionParams mapped;
+    for (SetuidFunctionParams::const_iterator it = params.begin(),
+             ie = params.end(); it != ie; ++it) {
+        mapped.push_back(map(static_cast<UID>(*it)));
+    }
+    return mapped;
+}
+
+SetuidFunctionParams UIDRelabeling::unmap(
+    SetuidFunctionParams const& params) const {
+    SetuidFunctionParams unmapped;
+    for (SetuidFunctionParams::const_iterator it = params.begin(),
+             ie = params.end(); it != ie; ++it) {
+        unmapped.push_back(unmap(static_cast<UID>(*it)));
+    }
+    return unmapped;
+}
+
+UIDSymmetry::UIDSymmetry(UIDSet const& uids, UIDSet const& fixed) :
+    permutable(),
+    permutableSet() {
+    for (UIDSet::const_iterator it = uids.begin(), ie = uids.end();
+         it != ie; ++it) {
+        if (fixed.find(*it) == fixed.end()) {
+            permutable.push_back(*it);
+            permutableSet.insert(*it);
+        }
+    }
+}
+
+UIDRelabeling UIDSymmetry::canonicalize(SetuidState const& ss) const {
+    UIDRelabeling r;
+    extend(r, ss);
+    return r;
+}
+
+void UIDSymmetry::extend(UIDRelabeling& r, SetuidState const& ss) const {
+    extend(r, ss.ruid);
+    extend(r, ss.euid);
+    extend(r, ss.svuid);
+}
+
+void UIDSymmetry::extend(
+    UIDRelabeling& r,
+    SetuidFunctionParams const& params) const {
+    for (SetuidFunctionParams::const_iterator it = params.begin(),
+             ie = params.end(); it != ie; ++it) {
+        extend(r, static_cast<UID>(*it));
+    }
+}
+
+bool UIDSymmetry::isRepresentative(
+    SetuidState const& ss,
+    SetuidFunctionParams const& params) const {
+    UIDRelabeling r = canonicalize(ss);
+    extend(r, params);
+    return r.map(params) == params;
+}
+
+void UIDSymmetry::extend(UIDRelabeling& r, UID uid) const {
+    if (permutableSet.find(uid) == permutableSet.end() ||
+        r.forward.find(uid) != r.forward.end()) {
+        return;
+    }
+    // r is injective on permutable UIDs, so there is always a free label
+    ASSERT(r.forward.size() < permutable.size());
+    UID const label = permutable.at(r.forward.size());
+    r.forward.insert(std::make_pair(uid, label));
+    r.backward.insert(std::make_pair(label, uid));
+}
+
+CallClass callClass(SetuidState const& ss, SetuidFunctionParams const& params) {
+    static UID const special = 0 - 1;
+    UID const known[] = { ss.ruid, ss.euid, ss.svuid, 0, special };
+    unsigned const numKnown = sizeof(known) / sizeof(known[0]);
+
+    CallClass cc;
+    std::vector<UID> others;
+    for (SetuidFunctionParams::const_iterator it = params.begin(),
+             ie = params.end(); it != ie; ++it) {
+        UID const uid = static_cast<UID>(*it);
+        int mask = 0;
+        for (unsigned i = 0; i < numKnown; ++i) {
+            if (uid == known[i]) {
+                mask |= 1 << i;
+            }
+        }
+        if (mask != 0) {
+            cc.push_back(mask);
+            continue;
+        }
+
+        // Other UIDs are numbered (negatively) in order of first occurrence
+        std::vector<UID>::const_iterator other =
+            std::find(others.begin(), others.end(), uid);
+        if (other == others.end()) {
+            others.push_back(uid);
+            other = others.end() - 1;
+        }
+        cc.push_back(-1 - static_cast<int>(other - others.begin()));
+    }
+    return cc;
+}
+
+SetuidState memberOutcome(
+    SetuidFunctionParams const& params,
+    SetuidFunctionParams const& member,
+    SetuidState const& outcome) {
+    ASSERT(params.size() == member.size());
+    std::map<UID, UID> relabel;
+    for (unsigned i = 0; i < params.size(); ++i) {
+        if (params.at(i) != member.at(i)) {
+            relabel[static_cast<UID>(params.at(i))] =
+                static_cast<UID>(member.at(i));
+        }
+    }
+
+    UID const ids[] = { outcome.ruid, outcome.euid, outcome.svuid };
+    UID mapped[3];
+    for (unsigned i = 0; i < 3; ++i) {
+        std::map<UID, UID>::const_iterator it = relabel.find(ids[i]);
+        mapped[i] = it == relabel.end() ? ids[i] : it->second;
+    }
+    return SetuidState(mapped[0], mapped[1], mapped[2]);
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "Graph.h"
+#include "SetuidState.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+// Unprivileged UIDs are interchangeable as far as the setuid family of
+// functions is concerned: permuting them maps every observed transition onto
+// another valid transition. Exploration can therefore be limited to one
+// representative per orbit: the state (and, from that state, the call) in
+// which the permutable UIDs appear in sorted order of first occurrence.
+
+// A partial bijection between UIDs; UIDs outside of it map to themselves, so
+// extend it over every permutable UID of a value before mapping the value
+class UIDRelabeling {
+    friend class UIDSymmetry;
+
+public:
+    UID map(UID uid) const;
+    UID unmap(UID uid) const;
+
+    SetuidState map(SetuidState const& ss) const;
+    SetuidState unmap(SetuidState const& ss) const;
+
+    SetuidFunctionParams map(SetuidFunctionParams const& params) const;
+    SetuidFunctionParams unmap(SetuidFunctionParams const& params) const;
+
+private:
+    typedef std::map<UID, UID> UIDMap;
+
+    UIDMap forward;
+    UIDMap backward;
+};
+
+class UIDSymmetry {
+public:
+    // Nothing is permutable
+    UIDSymmetry() : permutable(), permutableSet() {}
+
+    // UIDs in uids but not in fixed are permutable
+    UIDSymmetry(UIDSet const& uids, UIDSet const& fixed);
+
+    // The relabeling that takes ss to its orbit's representative
+    UIDRelabeling canonicalize(SetuidState const& ss) const;
+
+    // Relabel permutable UIDs that r does not cover yet, in order of first
+    // occurrence
+    void extend(UIDRelabeling& r, SetuidState const& ss) const;
+    void extend(UIDRelabeling& r, SetuidFunctionParams const& params) const;
+
+    SetuidState representative(SetuidState const& ss) const {
+        return canonicalize(ss).map(ss);
+    }
+
+    // Is params (as a call made from the representative state ss) the
+    // representative of its orbit under the permutations that fix ss?
+    bool isRepresentative(
+        SetuidState const& ss,
+        SetuidFunctionParams const& params) const;
+
+private:
+    std::vector<UID> permutable;
+    std::set<UID> permutableSet;
+
+    void extend(UIDRelabeling& r, UID uid) const;
+};
+
+// Calls from a given state also fall into classes that behave alike: all
+// that matters about a parameter is which of the state's UIDs, 0 and -1 it
+// equals, and otherwise only which of the call's other parameters it equals.
+typedef std::vector<int> CallClass;
+
+CallClass callClass(SetuidState const& ss, SetuidFunctionParams const& params);
+
+// Given the state reached by calling with params, the state reached by the
+// call with member instead (from the same state, in the same class)
+SetuidState memberOutcome(
+    SetuidFunctionParams const& params,
+    SetuidFunctionParams const& member,
+    SetuidState const& outcome);
@@ -21,9 +21,14 @@
 #include <boost/regex.hpp>
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
 
 #include <cstdlib>
 #include <climits>
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
 
 using namespace boost;
@@ -54,3 +59,59 @@ int stoi(char const* str, char** end, int base) {
     }
     return i;
 }
+
+bool writeFileAtomically(std::string const& path, std::string const& contents) {
+    std::string const tmpPath = path + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        return false;
+    }
+
+    char const* buffer = contents.data();
+    size_t size = contents.size();
+    while (size > 0) {
+        ssize_t written = write(fd, buffer, size);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            unlink(tmpPath.c_str());
+            return false;
+        }
+        buffer += written;
+        size -= written;
+    }
+
+    // Contents must be on disk before the rename makes them visible
+    if (fsync(fd) == -1 || close(fd) == -1) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    if (rename(tmpPath.c_str(), path.c_str()) == -1) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    // Persist the rename itself
+    std::string::size_type const slash = path.rfind('/');
+    std::string const dir = slash == std::string::npos ?
+        "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int dirFd = open(dir.c_str(), O_RDONLY);
+    if (dirFd != -1) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
+
+bool readFile(std::string const& path, std::string& contents) {
+    std::ifstream ifs(path.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!ifs) {
+        return false;
+    }
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    contents = oss.str();
+    return true;
+}
@@ -14,6 +14,15 @@
 //
 // You should have received a copy of the GNU General Public License
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
 
+#include <string>
 
 int stoi(char const* str, char** end, int base);
+
+// Replace the file at path with contents such that a crash at any point
+// leaves either the old file or the complete new one; returns false on error
+bool writeFileAtomically(std::string const& path, std::string const& contents);
+
+// Returns false if path cannot be read
+bool readFile(std::string const& path, std::string& contents);
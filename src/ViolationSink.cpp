@@ -0,0 +1,218 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "ViolationSink.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <utility>
+
+#ifdef MULTITHREADED
+#include <pthread.h>
+#endif
+
+unsigned const ViolationSink::noEdge = static_cast<unsigned>(-1);
+unsigned const ViolationSink::defaultCapacity;
+unsigned const ViolationSink::defaultMaxSamples;
+
+namespace {
+
+struct RuleRegistry {
+    std::map<std::string, ViolationSink::Rule> rules;
+    std::vector<std::string> descriptions;
+};
+
+RuleRegistry& ruleRegistry() {
+    static RuleRegistry registry;
+    return registry;
+}
+
+#ifdef MULTITHREADED
+pthread_mutex_t ruleRegistryLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+void writeCSVString(std::ostream& os, std::string const& str) {
+    os << '"';
+    for (std::string::const_iterator it = str.begin(), ie = str.end();
+         it != ie; ++it) {
+        if (*it == '"') {
+            os << '"';
+        }
+        os << *it;
+    }
+    os << '"';
+}
+
+void writeJSONString(std::ostream& os, std::string const& str) {
+    static char const hex[] = "0123456789abcdef";
+    os << '"';
+    for (std::string::const_iterator it = str.begin(), ie = str.end();
+         it != ie; ++it) {
+        unsigned char const c = *it;
+        switch (c) {
+        default:
+            if (c < 0x20) {
+                os << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+            } else {
+                os << *it;
+            }
+            break;
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        }
+    }
+    os << '"';
+}
+
+} // namespace
+
+ViolationSink::Rule ViolationSink::getRule(char const* desc) {
+#ifdef MULTITHREADED
+    pthread_mutex_lock(&ruleRegistryLock);
+#endif
+    RuleRegistry& registry = ruleRegistry();
+    std::pair<std::map<std::string, Rule>::iterator, bool> const inserted =
+        registry.rules.insert(
+            std::make_pair(desc, registry.descriptions.size()));
+    if (inserted.second) {
+        registry.descriptions.push_back(desc);
+    }
+    Rule const rule = inserted.first->second;
+#ifdef MULTITHREADED
+    pthread_mutex_unlock(&ruleRegistryLock);
+#endif
+    return rule;
+}
+
+std::string ViolationSink::getDescription(Rule rule) {
+#ifdef MULTITHREADED
+    pthread_mutex_lock(&ruleRegistryLock);
+#endif
+    std::string const desc = ruleRegistry().descriptions.at(rule);
+#ifdef MULTITHREADED
+    pthread_mutex_unlock(&ruleRegistryLock);
+#endif
+    return desc;
+}
+
+ViolationSink::ViolationSink(unsigned capacity) : violations() {
+    violations.reserve(capacity);
+}
+
+void ViolationSink::merge(ViolationSink const& other) {
+    violations.insert(
+        violations.end(),
+        other.violations.begin(),
+        other.violations.end());
+}
+
+void ViolationSink::report(
+    std::ostream& os,
+    Format format,
+    ViolationDescriber const& describer,
+    unsigned maxSamples) {
+    std::sort(violations.begin(), violations.end());
+    violations.erase(
+        std::unique(violations.begin(), violations.end()),
+        violations.end());
+
+    // Rules are listed by description, so reports do not depend on the order
+    // in which rules were first broken
+    typedef std::pair<ViolationList::const_iterator,
+                      ViolationList::const_iterator> ViolationRange;
+    std::map<std::string, ViolationRange> byRule;
+    for (ViolationList::const_iterator it = violations.begin(),
+             ie = violations.end(); it != ie;) {
+        ViolationList::const_iterator next = it;
+        while (next != ie && next->rule == it->rule) {
+            ++next;
+        }
+        byRule.insert(
+            std::make_pair(getDescription(it->rule),
+                           ViolationRange(it, next)));
+        it = next;
+    }
+
+    if (format == CSV) {
+        os << "\"Rule\",\"Violations\",\"Sample\"" << std::endl;
+    } else {
+        os << "{" << std::endl << "  \"rules\": [";
+    }
+    for (std::map<std::string, ViolationRange>::const_iterator
+             it = byRule.begin(), ie = byRule.end(); it != ie; ++it) {
+        ViolationList::const_iterator first = it->second.first;
+        ViolationList::const_iterator last = it->second.second;
+        unsigned const count = last - first;
+        if (count > maxSamples) {
+            last = first + maxSamples;
+        }
+        if (format == JSON) {
+            os << (it == byRule.begin() ? "" : ",") << std::endl
+               << "    {" << std::endl
+               << "      \"rule\": ";
+            writeJSONString(os, it->first);
+            os << "," << std::endl
+               << "      \"violations\": " << count << "," << std::endl
+               << "      \"samples\": [";
+        }
+        for (ViolationList::const_iterator vIt = first; vIt != last; ++vIt) {
+            std::stringstream sample;
+            describer.describe(sample, vIt->vertex, vIt->edge);
+            if (format == CSV) {
+                writeCSVString(os, it->first);
+                os << "," << count << ",";
+                writeCSVString(os, sample.str());
+                os << std::endl;
+            } else {
+                os << (vIt == first ? "" : ",") << std::endl
+                   << "        ";
+                writeJSONString(os, sample.str());
+            }
+        }
+        if (format == JSON) {
+            os << std::endl << "      ]" << std::endl << "    }";
+        }
+    }
+    if (format == JSON) {
+        os << std::endl << "  ]" << std::endl << "}" << std::endl;
+    }
+}
+
+bool ViolationSink::Violation::operator<(Violation const& other) const {
+    if (rule != other.rule) {
+        return rule < other.rule;
+    }
+    if (vertex != other.vertex) {
+        return vertex < other.vertex;
+    }
+    return edge < other.edge;
+}
+
+bool ViolationSink::Violation::operator==(Violation const& other) const {
+    return rule == other.rule && vertex == other.vertex && edge == other.edge;
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Describes the subject of a violation (a state, or a call made from one)
+// for a report. Only called for the samples that are printed.
+class ViolationDescriber {
+public:
+    virtual ~ViolationDescriber() {}
+
+    virtual void describe(
+        std::ostream& os,
+        unsigned vertex,
+        unsigned edge) const = 0;
+};
+
+// Collects violations of verification rules without formatting them.
+//
+// A violation is a rule number and the index of what broke it: a vertex, or
+// (vertex, edge) where edge is whatever numbering the caller gives the calls
+// made from that vertex. Recording one appends to a buffer; report() sorts
+// the buffer, drops duplicates, counts violations per rule and prints a
+// CSV or JSON report with up to maxSamples examples per rule (those with the
+// lowest indices), asking a ViolationDescriber to describe only those.
+//
+// Rules are numbered by description, on first use, across all sinks, so
+// sinks filled by different threads can be merged.
+class ViolationSink {
+public:
+    typedef unsigned Rule;
+
+    enum Format {
+        CSV,
+        JSON
+    };
+
+    // Edge index of a violation by a vertex
+    static unsigned const noEdge;
+
+    static unsigned const defaultCapacity = 4096;
+    static unsigned const defaultMaxSamples = 5;
+
+    static Rule getRule(char const* desc);
+    static std::string getDescription(Rule rule);
+
+    explicit ViolationSink(unsigned capacity = defaultCapacity);
+
+    void record(Rule rule, unsigned vertex, unsigned edge = noEdge) {
+        violations.push_back(Violation(rule, vertex, edge));
+    }
+
+    void merge(ViolationSink const& other);
+
+    bool empty() const { return violations.empty(); }
+
+    void report(
+        std::ostream& os,
+        Format format,
+        ViolationDescriber const& describer,
+        unsigned maxSamples = defaultMaxSamples);
+
+private:
+    struct Violation {
+        Violation(Rule _rule, unsigned _vertex, unsigned _edge) :
+            rule(_rule), vertex(_vertex), edge(_edge) {}
+
+        bool operator<(Violation const& other) const;
+        bool operator==(Violation const& other) const;
+
+        Rule rule;
+        unsigned vertex;
+        unsigned edge;
+    };
+    typedef std::vector<Violation> ViolationList;
+
+    ViolationList violations;
+};
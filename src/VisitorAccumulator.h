@@ -106,40 +106,40 @@ public:
         Graph const& graph,
         typename Graph::Vertex start) const {
         UIDs uids;
-        boost::breadth_first_search(
-            graph.getGraph(),
+        visitBreadthFirst(
+            graph,
             start,
-            boost::visitor(UIDAccumulatorVisitor<Graph>(uids)));
+            UIDAccumulatorVisitor<Graph>(uids));
         return uids;
     }
     Vertices generateVertices(
         Graph const& graph,
         typename Graph::Vertex start) const {
         Vertices vertices;
-        boost::breadth_first_search(
-            graph.getGraph(),
+        visitBreadthFirst(
+            graph,
             start,
-            boost::visitor(VertexAccumulatorVisitor<Graph>(vertices)));
+            VertexAccumulatorVisitor<Graph>(vertices));
         return vertices;
     }
     Jumps generatePrivJumps(
         Graph const& graph,
         typename Graph::Vertex start) const {
         Jumps jumps;
-        boost::breadth_first_search(
-            graph.getGraph(),
+        visitBreadthFirst(
+            graph,
             start,
-            boost::visitor(PrivJumpAccumulatorVisitor<Graph>(graph, jumps)));
+            PrivJumpAccumulatorVisitor<Graph>(graph, jumps));
         return jumps;
     }
     Edges generateEdges(
         Graph const& graph,
         typename Graph::Vertex const& start) const {
         Edges edges;
-        boost::breadth_first_search(
-            graph.getGraph(),
+        visitBreadthFirst(
+            graph,
             start,
-            boost::visitor(EdgeAccumulatorVisitor<Graph>(edges)));
+            EdgeAccumulatorVisitor<Graph>(edges));
         return edges;
     }
 };
@@ -155,10 +155,10 @@ public:
         Graph const& graph,
         typename Graph::Vertex const& start) const {
         EdgeMap em;
-        boost::breadth_first_search(
-            graph.getGraph(),
+        visitBreadthFirst(
+            graph,
             start,
-            boost::visitor(EdgeMapAccumulatorVisitor<Graph>(em)));
+            EdgeMapAccumulatorVisitor<Graph>(em));
         return em;
     }
 };
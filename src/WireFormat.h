@@ -0,0 +1,249 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "SetuidState.h"
+
+#include <stdint.h>
+
+#include <cstring>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/mpl/bool.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/type_traits/is_enum.hpp>
+
+// Compact binary encoding for values sent between processes of one build on
+// one machine. Fields are visited by the types' own serialize() functions:
+// scalars and enums are sent as their native bytes, containers as a count
+// followed by their elements. There is no versioning, tracking or text
+// formatting. Error descriptions are not sent; they are derived from the
+// error number. Decoding a buffer that ends too soon fails, rather than
+// reading past its end.
+
+typedef uint32_t WireCount;
+
+class WireWriter {
+public:
+    typedef boost::mpl::bool_<true> is_saving;
+    typedef boost::mpl::bool_<false> is_loading;
+
+    explicit WireWriter(std::string& _buffer) : buffer(_buffer) {}
+
+    template<typename T>
+    WireWriter& operator&(T const& t) {
+        save(t);
+        return *this;
+    }
+
+    template<typename T>
+    WireWriter& operator<<(T const& t) {
+        save(t);
+        return *this;
+    }
+
+private:
+    std::string& buffer;
+
+    template<typename T>
+    void save(T const& t) {
+        saveValue(t, boost::mpl::bool_<
+                  boost::is_arithmetic<T>::value || boost::is_enum<T>::value>());
+    }
+
+    template<typename T>
+    void saveValue(T const& t, boost::mpl::true_) {
+        buffer.append(reinterpret_cast<char const*>(&t), sizeof(T));
+    }
+
+    template<typename T>
+    void saveValue(T const& t, boost::mpl::false_) {
+        boost::serialization::serialize_adl(*this, const_cast<T&>(t), 0);
+    }
+
+    template<typename Container>
+    void saveElements(Container const& c) {
+        save(static_cast<WireCount>(c.size()));
+        for (typename Container::const_iterator it = c.begin(), ie = c.end();
+             it != ie; ++it) {
+            save(*it);
+        }
+    }
+
+    template<typename T>
+    void save(std::vector<T> const& v) { saveElements(v); }
+
+    template<typename T>
+    void save(std::list<T> const& l) { saveElements(l); }
+
+    template<typename T>
+    void save(std::set<T> const& s) { saveElements(s); }
+
+    void save(std::string const& s) {
+        save(static_cast<WireCount>(s.size()));
+        buffer.append(s);
+    }
+
+    void save(SetuidFunctionReturn const& r) {
+        save(r.value);
+        save(r.errNumber);
+    }
+};
+
+class WireReader {
+public:
+    typedef boost::mpl::bool_<false> is_saving;
+    typedef boost::mpl::bool_<true> is_loading;
+
+    WireReader(char const* _data, size_t size) :
+        data(_data), end(_data + size), failed(false) {}
+
+    // Whether every load so far found its bytes
+    bool ok() const { return !failed; }
+    bool done() const { return !failed && data == end; }
+
+    template<typename T>
+    WireReader& operator&(T& t) {
+        load(t);
+        return *this;
+    }
+
+    template<typename T>
+    WireReader& operator>>(T& t) {
+        load(t);
+        return *this;
+    }
+
+private:
+    char const* data;
+    char const* const end;
+    // Set by the first load that runs out of bytes; later loads read
+    // nothing
+    bool failed;
+
+    size_t remaining() const { return end - data; }
+
+    // Claim size bytes, or fail if fewer are left
+    bool take(size_t size) {
+        if (failed || remaining() < size) {
+            failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    template<typename T>
+    void load(T& t) {
+        loadValue(t, boost::mpl::bool_<
+                  boost::is_arithmetic<T>::value || boost::is_enum<T>::value>());
+    }
+
+    template<typename T>
+    void loadValue(T& t, boost::mpl::true_) {
+        if (!take(sizeof(T))) {
+            return;
+        }
+        std::memcpy(&t, data, sizeof(T));
+        data += sizeof(T);
+    }
+
+    template<typename T>
+    void loadValue(T& t, boost::mpl::false_) {
+        boost::serialization::serialize_adl(*this, t, 0);
+    }
+
+    // Every element takes at least one byte, so a count beyond the bytes
+    // left cannot be right
+    WireCount loadCount() {
+        WireCount count = 0;
+        load(count);
+        if (!failed && count > remaining()) {
+            failed = true;
+        }
+        return failed ? 0 : count;
+    }
+
+    template<typename T>
+    void load(std::vector<T>& v) {
+        WireCount const count = loadCount();
+        v.clear();
+        v.reserve(count);
+        for (WireCount i = 0; i < count && !failed; ++i) {
+            v.push_back(T());
+            load(v.back());
+        }
+    }
+
+    template<typename T>
+    void load(std::list<T>& l) {
+        WireCount const count = loadCount();
+        l.clear();
+        for (WireCount i = 0; i < count && !failed; ++i) {
+            l.push_back(T());
+            load(l.back());
+        }
+    }
+
+    // Elements arrive in order, so each goes in at the end
+    template<typename T>
+    void load(std::set<T>& s) {
+        WireCount const count = loadCount();
+        s.clear();
+        for (WireCount i = 0; i < count; ++i) {
+            T t;
+            load(t);
+            if (failed) {
+                break;
+            }
+            s.insert(s.end(), t);
+        }
+    }
+
+    void load(std::string& s) {
+        WireCount const count = loadCount();
+        if (!take(count)) {
+            return;
+        }
+        s.assign(data, count);
+        data += count;
+    }
+
+    void load(SetuidFunctionReturn& r) {
+        load(r.value);
+        load(r.errNumber);
+    }
+};
+
+template<typename T>
+std::string wireEncode(T const& t) {
+    std::string buffer;
+    WireWriter w(buffer);
+    w << t;
+    return buffer;
+}
+
+// False if buffer does not hold exactly one encoded T
+template<typename T>
+bool wireDecode(std::string const& buffer, T& t) {
+    WireReader r(buffer.data(), buffer.size());
+    r >> t;
+    return r.done();
+}
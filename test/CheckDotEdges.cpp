@@ -0,0 +1,88 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+#include "Platform.h"
+#include "SetuidState.h"
+#include "Graph.h"
+#include "GraphReader.h"
+#include "Util.h"
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/graph/adj_list_serialize.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/map.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+typedef SetuidState VP;
+typedef SetuidFunctionCall EP;
+typedef VertexGenerator<UID, SetuidState> VG;
+typedef SetuidEdgeGenerator EG;
+
+typedef SetuidStateGraph<VP, EP, VG, EG> Graph;
+
+// Edges in an archive's graph, failed calls included
+static unsigned long countGraphEdges(Graph const& graph) {
+    Graph::Graph const& boostGraph = graph.getGraph();
+    unsigned long numEdges = boost::num_edges(boostGraph);
+    for (Graph::Vertex v = 0; v < boost::num_vertices(boostGraph); ++v) {
+        numEdges += graph.getFailedEdges(v).size();
+    }
+    return numEdges;
+}
+
+// Edges in a .dot file, one "u->v [label=...]" per line
+static unsigned long countDotEdges(std::string const& path) {
+    std::ifstream ifs(path.c_str(), std::ifstream::in);
+    unsigned long numEdges = 0;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.find("->") != std::string::npos) {
+            ++numEdges;
+        }
+    }
+    return numEdges;
+}
+
+// Checks that the .dot file written next to each archive holds every edge of
+// the archive's graph, failed calls included
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "ERROR: Must have at least one argument: archive-file-basename"
+                  << std::endl;
+        return -1;
+    }
+
+    int rtn = 0;
+    ArchiveReader<Graph> reader;
+    for (int i = 1; i < argc; ++i) {
+        std::string const name(argv[i]);
+        unsigned long const graphEdges = countGraphEdges(reader.read(name));
+        unsigned long const dotEdges = countDotEdges(name + ".dot");
+        if (dotEdges != graphEdges) {
+            std::cerr << "ERROR: " << name << ".dot has " << dotEdges
+                      << " edges; its archive has " << graphEdges << std::endl;
+            rtn = -1;
+        } else {
+            std::cerr << " :: " << name << ".dot has all " << graphEdges
+                      << " edges" << std::endl;
+        }
+    }
+
+    return rtn;
+}
@@ -16,10 +16,13 @@
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include "CollectorOptions.h"
 #include "Platform.h"
 #include "SetuidState.h"
 #include "Graph.h"
 #include "GraphExplorer.h"
+#include "GraphName.h"
+#include "GraphReader.h"
 #include "GraphVerification.h"
 #include "GraphWriter.h"
 #include "Util.h"
@@ -32,6 +35,7 @@
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/map.hpp>
 
+#include <algorithm>
 #include <fstream>
 
 // typedef boost::default_bfs_visitor GraphVisitor;
@@ -57,21 +61,27 @@ static void visitGraph(
 
 int main(int argc, char* argv[]) {
     UIDSet uids;
+    CollectorOptions options;
 
-    if (argc < 3) {
+    int const argi = parseCollectorOptions(argc, argv, options);
+    if (argi == -1) {
+        return -1;
+    }
+
+    if (argc - argi < 2) {
         std::cerr << "ERROR: Must have at least two arguments: basename and a UID"
                   << std::endl;
         return -1;
     }
 
     try {
-        stoi(argv[1], NULL, 10);
+        stoi(argv[argi], NULL, 10);
         std::cerr << "ERROR: First argument must not be an integer"
                   << std::endl;
         return -1;
     } catch (...) {}
 
-    std::string basename(std::string(argv[1]) + "_mixed");
+    std::string basename = std::string(argv[argi]) + "_mixed";
 
     if (basename.find("/") != std::string::npos) {
         std::cerr << "ERROR: Basename may not contain path separator"
@@ -79,22 +89,98 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
-    for (int i = 2; i < argc; ++i) {
+    for (int i = argi + 1; i < argc; ++i) {
         uids.insert(stoi(argv[i], NULL, 10));
     }
     ParamSet extraParams;
     extraParams.insert(-1); // Don't-care value
-    SetuidState startState = SetuidState::get();
+    SetuidState const startState = SetuidState::get();
+    if (uids.find(startState.ruid) == uids.end() ||
+        uids.find(startState.euid) == uids.end() ||
+        uids.find(startState.svuid) == uids.end()) {
+        std::cerr << "ERROR: Start state " << startState
+                  << " has a UID that is not among the UIDs" << std::endl;
+        return -1;
+    }
     Explorer explorer(
         Graph(VG(), uids, startState),
         EG(),
         uids,
         extraParams);
 
+    if (options.symmetric &&
+        (options.resume || !options.incremental.empty())) {
+        std::cerr << "ERROR: Symmetric collection cannot resume or extend "
+                  << "an earlier collection" << std::endl;
+        return -1;
+    }
+    if (options.forkTree &&
+        (options.symmetric || options.callClasses ||
+         options.resume || !options.incremental.empty())) {
+        std::cerr << "ERROR: Fork-tree collection explores every call from "
+                  << "scratch" << std::endl;
+        return -1;
+    }
+    if (options.simulate) {
+        std::cerr << "ERROR: Only setuid-family calls can be simulated"
+                  << std::endl;
+        return -1;
+    }
+
+    GraphName name(basename, uids, extraParams);
+    std::string const checkpoint = name.getName() + ".checkpoint";
+
+    explorer.setWorkerPoolSize(options.workers);
+    explorer.setForkTree(options.forkTree);
+    explorer.setSharedResults(options.sharedResults);
+    explorer.setProbeTimeout(options.probeTimeout);
+    explorer.setCloneProbes(options.cloneProbes);
+    if (options.symmetric) {
+        explorer.enableSymmetryReduction(uids);
+    } else if (!options.forkTree) {
+        explorer.setCheckpoint(checkpoint, options.checkpointInterval);
+    }
+    if (options.callClasses) {
+        explorer.enableCallClasses();
+    }
+    if (!options.incremental.empty()) {
+        std::string previousBasename;
+        UIDSet previousUIDs;
+        ParamSet previousParams;
+        if (!GraphName::parse(options.incremental, previousBasename,
+                              previousUIDs, previousParams) ||
+            !std::includes(uids.begin(), uids.end(),
+                           previousUIDs.begin(), previousUIDs.end()) ||
+            !std::includes(extraParams.begin(), extraParams.end(),
+                           previousParams.begin(), previousParams.end())) {
+            std::cerr << "ERROR: Incremental collection must start from an "
+                      << "archive over a subset of the UIDs and params"
+                      << std::endl;
+            return -1;
+        }
+        if (!explorer.seedFromGraph(
+                ArchiveReader<Graph>().read(options.incremental))) {
+            std::cerr << "ERROR: " << options.incremental
+                      << " does not fit in the new graph" << std::endl;
+            return -1;
+        }
+    }
+    if (options.resume) {
+        if (explorer.resumeFromCheckpoint(checkpoint)) {
+            std::cerr << "Resuming from " << checkpoint << std::endl;
+        } else {
+            std::cerr << "No usable checkpoint at " << checkpoint
+                      << "; starting from scratch" << std::endl;
+        }
+    }
     explorer.exploreAll();
+    if (explorer.getGivenUp() != 0) {
+        std::cerr << "ERROR: Gave up on " << explorer.getGivenUp()
+                  << " calls; not writing an incomplete graph" << std::endl;
+        return -1;
+    }
 
     Graph const& graph = explorer.getGraph();
-    GraphName name(basename, uids, extraParams);
     ArchiveWriter<Graph>().write(graph, name);
     DotWriter<Graph>().write(graph, name);
 
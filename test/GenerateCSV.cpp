@@ -18,6 +18,7 @@
 
 #include "Platform.h"
 #include "SetuidState.h"
+#include "FrozenGraph.h"
 #include "Graph.h"
 #include "GraphVerification.h"
 #include "GraphReader.h"
@@ -40,7 +41,8 @@ typedef SetuidFunctionCall EP;
 typedef VertexGenerator<UID, SetuidState> VG;
 typedef SetuidEdgeGenerator EG;
 
-typedef SetuidStateGraph<VP, EP, VG, EG> Graph;
+typedef SetuidStateGraph<VP, EP, VG, EG> SourceGraph;
+typedef FrozenSetuidStateGraph<EP, VG, EG> Graph;
 
 #define VISITOR(_name) _name ## Visitor<Graph>
 
@@ -48,10 +50,10 @@ template<typename Visitor>
 static void visitGraph(
     Graph const& graph,
     Graph::Vertex const& start) {
-        boost::breadth_first_search(
-            graph.getGraph(),
+        visitBreadthFirst(
+            graph,
             start,
-            boost::visitor(Visitor(graph)));
+            Visitor(graph));
 }
 
 int main(int argc, char* argv[]) {
@@ -68,10 +70,10 @@ int main(int argc, char* argv[]) {
         names.push_back(argv[i]);
     }
 
-    ArchiveReader<Graph> reader;
+    ArchiveReader<SourceGraph> reader;
     for (std::vector<std::string>::const_iterator it = names.begin(),
              ie = names.end(); it != ie; ++it) {
-        Graph const graph = reader.read(*it);
+        Graph const graph = freeze(reader.read(*it));
 
         std::cerr << std::endl << " :: Writing to " << *it << ".csv"
                   << std::endl;
@@ -16,6 +16,7 @@
 // along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include "FrozenGraph.h"
 #include "Graph.h"
 #include "GraphReader.h"
 #include "GraphWriter.h"
@@ -41,7 +42,8 @@ typedef SetuidFunctionCall EP;
 typedef VertexGenerator<UID, SetuidState> VG;
 typedef SetuidEdgeGenerator EG;
 
-typedef SetuidStateGraph<VP, EP, VG, EG> Graph;
+typedef SetuidStateGraph<VP, EP, VG, EG> SourceGraph;
+typedef FrozenSetuidStateGraph<EP, VG, EG> Graph;
 
 int main(int argc, char* argv[]) {
     std::vector<std::string> names;
@@ -58,10 +60,10 @@ int main(int argc, char* argv[]) {
         names.push_back(argv[i]);
     }
 
-    ArchiveReader<Graph> reader;
+    ArchiveReader<SourceGraph> reader;
     for (std::vector<std::string>::const_iterator it = names.begin(),
              ie = names.end(); it != ie; ++it) {
-        Graph const graph = reader.read(*it);
+        Graph const graph = freeze(reader.read(*it));
         ModuleGenerator<Graph> generator(graph);
 
         std::stringstream sourceName;
@@ -17,24 +17,13 @@
 
 
 #include "Graph.h"
-#include "GraphReader.h"
-#include "GraphVerification.h"
-#include "GraphWriter.h"
+#include "GraphName.h"
 #include "Platform.h"
 #include "SetuidState.h"
+#include "StreamingNormalizer.h"
 #include "Util.h"
 
-#include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
-#include <boost/graph/adj_list_serialize.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/graphviz.hpp>
-#include <boost/serialization/map.hpp>
-#include <boost/serialization/vector.hpp>
-
-#include <fstream>
-
-using namespace boost;
+#include <iostream>
 
 typedef SetuidState VP;
 typedef SetuidFunctionCall EP;
@@ -42,25 +31,6 @@ typedef VertexGenerator<UID, SetuidState> VG;
 typedef SetuidEdgeGenerator EG;
 
 typedef SetuidStateGraph<VP, EP, VG, EG> Graph;
-typedef Normalizer<Graph> NormalizerType;
-
-template<typename Visitor>
-static Graph bfsTransform(
-    Graph& graph,
-    Graph::Vertex const& startVertex,
-    UIDSet const& uidSet) {
-    Graph::VertexPropertyType const& startState =
-        get(vertex_bundle, graph.getGraph(), startVertex);
-    UIDMap mapping = NormalizerType::generateUIDMap(uidSet);
-    UIDSet newUIDSet = NormalizerType::generateUIDSet(mapping);
-    SetuidState newStartState = NormalizerType::mapState(mapping, startState);
-    Graph rtn(VertexGenerator<UID, SetuidState>(), newUIDSet, newStartState);
-    breadth_first_search(
-        graph.getGraph(),
-        startVertex,
-        visitor(Visitor(rtn, mapping)));
-    return rtn;
-}
 
 int main(int argc, char* argv[]) {
     UIDSet uids;
@@ -87,18 +57,13 @@ int main(int argc, char* argv[]) {
     extraParams.insert(-1); // Don't-care value
 
     GraphName inName(basename, uids, extraParams);
-    Graph graph = ArchiveReader<Graph>().read(inName);
-
-    Graph::Vertex const& startVertex =
-        graph.getVertex(graph.getStart());
-    Graph newGraph =
-        bfsTransform<NormalizerType>(graph, startVertex, uids);
-
     GraphName outName(basename + "__Normalized", uids, extraParams);
-    std::cout << "Writing archive..." << std::endl;
-    ArchiveWriter<Graph>().write(newGraph, outName);
-    std::cout << "Writing graphviz..." << std::endl;
-    DotWriter<Graph>().write(newGraph, outName);
+
+    // Each state and call is written out as soon as it is read
+    std::cout << "Writing archive and graphviz..." << std::endl;
+    if (!StreamingNormalizer<Graph>(uids).normalize(inName, outName)) {
+        return -1;
+    }
 
     return 0;
 }
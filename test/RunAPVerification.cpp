@@ -18,6 +18,8 @@
 
 #include "Platform.h"
 #include "SetuidState.h"
+#include "FrozenGraph.h"
+#include "FusedVerifier.h"
 #include "Graph.h"
 #include "GraphVerification.h"
 #include "GraphReader.h"
@@ -39,69 +41,85 @@ typedef SetuidFunctionCall EP;
 typedef VertexGenerator<UID, SetuidState> VG;
 typedef SetuidEdgeGenerator EG;
 
-typedef SetuidStateGraph<VP, EP, VG, EG> Graph;
+typedef SetuidStateGraph<VP, EP, VG, EG> SourceGraph;
+typedef FrozenSetuidStateGraph<EP, VG, EG> Graph;
 
 #define VISITOR(_name) _name ## Visitor<Graph>
 
-template<typename Visitor>
-static void visitGraph(
-    Graph const& graph,
-    Graph::Vertex const& start) {
-        boost::breadth_first_search(
-            graph.getGraph(),
-            start,
-            boost::visitor(Visitor(graph)));
-}
+// Clean tests; other than FreeBSD's out-of-date setuid(), these tests should
+// report no errors
+typedef Checks< VISITOR(SetuidTautology),
+        Checks< VISITOR(SeteuidTautology),
+        Checks< VISITOR(SetreuidCleanTautology),
+        Checks< VISITOR(SetresuidTautology) > > > > CleanChecks;
+
+// Debug tests: These are used to expose irregularities with respect to
+// "normal behaviour"; "--debug" runs them after the clean tests. They are
+// named here, rather than listed in a comment, so that they keep compiling
+//
+// Test actual setreuid() standard (there are many failures):
+//   SetreuidTautology, SetreuidForDropPrivPerm
+//
+// Test: setuid(): euid=0 does not imply NOT appropriate privileges (this
+// should always pass):
+//   SetuidRootAP
+//
+// Test: setuid(): euid!=0 does not imply appropriate privileges (this will
+// fail in cases where appropriate privileges is more complicated):
+//   SetuidNonRootNAP
+//
+// And the same for seteuid():
+//   SeteuidRootAP, SeteuidNonRootNAP
+typedef Checks< VISITOR(SetreuidTautology),
+        Checks< VISITOR(SetreuidForDropPrivPerm),
+        Checks< VISITOR(SetuidRootAP),
+        Checks< VISITOR(SetuidNonRootNAP),
+        Checks< VISITOR(SeteuidRootAP),
+        Checks< VISITOR(SeteuidNonRootNAP) > > > > > > DebugChecks;
 
 int main(int argc, char* argv[]) {
     std::vector<std::string> names;
     UIDSet uids;
 
-    if (argc < 2) {
+    // Violations are reported on stdout as CSV, or as JSON given "--json"
+    ViolationSink::Format format = ViolationSink::CSV;
+    bool debug = false;
+    int argi = 1;
+    for (; argi < argc; ++argi) {
+        std::string const arg(argv[argi]);
+        if (arg == "--json") {
+            format = ViolationSink::JSON;
+        } else if (arg == "--debug") {
+            debug = true;
+        } else {
+            break;
+        }
+    }
+
+    if (argc - argi < 1) {
         std::cerr << "ERROR: Must have at least one argument: archive-file-basename"
                   << std::endl;
         return -1;
     }
 
-    for (int i = 1; i < argc; ++i) {
+    for (int i = argi; i < argc; ++i) {
         names.push_back(argv[i]);
     }
 
-    ArchiveReader<Graph> reader;
+    ArchiveReader<SourceGraph> reader;
     for (std::vector<std::string>::const_iterator it = names.begin(),
              ie = names.end(); it != ie; ++it) {
-        Graph const graph = reader.read(*it);
-        Graph::Vertex const& start =
-            graph.getVertex(graph.getStart());
+        Graph const graph = freeze(reader.read(*it));
 
         std::cerr << std::endl << " :: Verifying \"" << *it << "\""
                   << std::endl;
 
-        // Clean tests; other than FreeBSD's out-of-date setuid(), these tests
-        // should report no errors
-        visitGraph< VISITOR(SetuidTautology) >(graph, start);
-        visitGraph< VISITOR(SeteuidTautology) >(graph, start);
-        visitGraph< VISITOR(SetreuidCleanTautology) >(graph, start);
-        visitGraph< VISITOR(SetresuidTautology) >(graph, start);
-
-        // Debug tests: These are used to expose irregularities with respect
-        // to "normal behaviour"
-
-        // Test actual setreuid() standard (there are many failures)
-        // visitGraph< VISITOR(SetreuidTautology) >(graph, start);
-
-        // visitGraph< VISITOR(SetreuidForDropPrivPerm) >(graph, start);
-
-        // Test: setuid(): euid=0 does not imply NOT appropriate privileges
-        // (this should always pass)
-        // visitGraph< VISITOR(SetuidRootAP) >(graph, start);
-
-        // Test: setuid(): euid!=0 does not imply appropriate privileges (this
-        // will fail in cases where appropriate privileges is more complicated)
-        // visitGraph< VISITOR(SetuidNonRootNAP) >(graph, start);
-
-        // visitGraph< VISITOR(SeteuidRootAP) >(graph, start);
-        // visitGraph< VISITOR(SeteuidNonRootNAP) >(graph, start);
+        ViolationSink sink;
+        FusedVerifier<Graph, CleanChecks>(graph).verify(sink);
+        if (debug) {
+            FusedVerifier<Graph, DebugChecks>(graph).verify(sink);
+        }
+        sink.report(std::cout, format, FusedVerifierDescriber<Graph>(graph));
     }
 
     return 0;
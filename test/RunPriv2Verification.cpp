@@ -19,6 +19,8 @@
 #include "Platform.h"
 #include "Priv2State.h"
 #include "SetuidState.h"
+#include "FrozenGraph.h"
+#include "FusedVerifier.h"
 #include "Graph.h"
 #include "GraphVerification.h"
 #include "GraphReader.h"
@@ -42,49 +44,43 @@ typedef VertexGenerator<UID, SetuidState> VG;
 typedef SetuidEdgeGenerator EG;
 
 typedef SetuidStateGraph<VP, EP, VG, EG> Graph;
+typedef FrozenSetuidStateGraph<EP, VG, EG> FrozenGraph;
 
-#define VISITOR(_name) _name ## Visitor<Graph>
-
-template<typename Visitor>
-static void visitGraph(
-    Graph const& graph,
-    Graph::Vertex const& start) {
-        boost::breadth_first_search(
-            graph.getGraph(),
-            start,
-            boost::visitor(Visitor(graph)));
-}
-
-template<typename Visitor>
-static void visitGraph2(
-    Graph const& graph,
-    Graph::Vertex const& start,
-    Priv2CallSet const& calls) {
-        boost::breadth_first_search(
-            graph.getGraph(),
-            start,
-            boost::visitor(Visitor(graph, calls)));
-}
+typedef Checks< GeneralSanityVisitor<FrozenGraph> > GeneralChecks;
 
 int main(int argc, char* argv[]) {
     std::string name;
     UIDSet uids;
 
-    if (argc < 3) {
-        std::cerr << "ERROR: Must have at least two argument: archive-file-basename uid1 [uid2 ...]"
+    // Violations are reported on stdout as CSV, or as JSON given "--json";
+    // "--symmetric" probes one call per orbit of UIDs other than 0 and -1
+    ViolationSink::Format format = ViolationSink::CSV;
+    bool symmetric = false;
+    int argi = 1;
+    for (; argi < argc; ++argi) {
+        std::string const arg(argv[argi]);
+        if (arg == "--json") {
+            format = ViolationSink::JSON;
+        } else if (arg == "--symmetric") {
+            symmetric = true;
+        } else {
+            break;
+        }
+    }
+
+    if (argc - argi < 2) {
+        std::cerr << "ERROR: Must have at least two argument: [--json] [--symmetric] archive-file-basename uid1 [uid2 ...]"
                   << std::endl;
         return -1;
     }
 
-    name = argv[1];
-    for (int i = 2; i < argc; ++i) {
+    name = argv[argi];
+    for (int i = argi + 1; i < argc; ++i) {
         uids.insert(stoi(argv[i], NULL, 10));
     }
 
     ArchiveReader<Graph> reader;
     Graph const graph = reader.read(name);
-    Graph::Vertex const& start =
-        graph.getVertex(graph.getStart());
 
     // Generate all priv2 calls based on UID set (don't bother with any
     // "extra params")
@@ -95,8 +91,26 @@ int main(int argc, char* argv[]) {
     std::cerr << std::endl << " :: Verifying \"" << name << "\""
               << std::endl;
 
-    visitGraph< VISITOR(GeneralSanity) >(graph, start);
-    visitGraph2< VISITOR(Priv2Sanity) >(graph, start, calls);
+    FrozenGraph const frozen = freeze(graph);
+    ViolationSink generalSink;
+    FusedVerifier<FrozenGraph, GeneralChecks>(frozen).verify(generalSink);
+    generalSink.report(
+        std::cout,
+        format,
+        FusedVerifierDescriber<FrozenGraph>(frozen));
+
+    // Priv2 checks make real calls, in forked probes, a window of states at
+    // a time
+    ViolationSink priv2Sink;
+    Priv2SanityVisitor<Graph> priv2Sanity(graph, calls);
+    if (symmetric) {
+        priv2Sanity.enableSymmetryReduction(uids);
+    }
+    priv2Sanity.verify(priv2Sink);
+    priv2Sink.report(
+        std::cout,
+        format,
+        Priv2SanityDescriber<Graph>(graph, calls));
 
     return 0;
 }
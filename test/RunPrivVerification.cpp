@@ -18,6 +18,8 @@
 
 #include "Platform.h"
 #include "SetuidState.h"
+#include "FrozenGraph.h"
+#include "FusedVerifier.h"
 #include "Graph.h"
 #include "GraphVerification.h"
 #include "GraphReader.h"
@@ -39,49 +41,50 @@ typedef SetuidFunctionCall EP;
 typedef VertexGenerator<UID, SetuidState> VG;
 typedef SetuidEdgeGenerator EG;
 
-typedef SetuidStateGraph<VP, EP, VG, EG> Graph;
+typedef SetuidStateGraph<VP, EP, VG, EG> SourceGraph;
+typedef FrozenSetuidStateGraph<EP, VG, EG> Graph;
 
 #define VISITOR(_name) _name ## Visitor<Graph>
 
-template<typename Visitor>
-static void visitGraph(
-    Graph const& graph,
-    Graph::Vertex const& start) {
-        boost::breadth_first_search(
-            graph.getGraph(),
-            start,
-            boost::visitor(Visitor(graph)));
-}
+typedef Checks< VISITOR(GeneralSanity),
+        Checks< VISITOR(PrivSanity),
+        Checks< VISITOR(DropPrivPermSanity),
+        Checks< VISITOR(DropPrivTempSanity),
+        Checks< VISITOR(RestorePrivSanity) > > > > > PrivChecks;
 
 int main(int argc, char* argv[]) {
     std::vector<std::string> names;
     UIDSet uids;
 
-    if (argc < 2) {
+    // Violations are reported on stdout as CSV, or as JSON given "--json"
+    ViolationSink::Format format = ViolationSink::CSV;
+    int argi = 1;
+    if (argi < argc && std::string(argv[argi]) == "--json") {
+        format = ViolationSink::JSON;
+        ++argi;
+    }
+
+    if (argc - argi < 1) {
         std::cerr << "ERROR: Must have at least one argument: archive-file-basename"
                   << std::endl;
         return -1;
     }
 
-    for (int i = 1; i < argc; ++i) {
+    for (int i = argi; i < argc; ++i) {
         names.push_back(argv[i]);
     }
 
-    ArchiveReader<Graph> reader;
+    ArchiveReader<SourceGraph> reader;
     for (std::vector<std::string>::const_iterator it = names.begin(),
              ie = names.end(); it != ie; ++it) {
-        Graph const graph = reader.read(*it);
-        Graph::Vertex const& start =
-            graph.getVertex(graph.getStart());
+        Graph const graph = freeze(reader.read(*it));
 
         std::cerr << std::endl << " :: Verifying \"" << *it << "\""
                   << std::endl;
 
-        visitGraph< VISITOR(GeneralSanity) >(graph, start);
-        visitGraph< VISITOR(PrivSanity) >(graph, start);
-        visitGraph< VISITOR(DropPrivPermSanity) >(graph, start);
-        visitGraph< VISITOR(DropPrivTempSanity) >(graph, start);
-        visitGraph< VISITOR(RestorePrivSanity) >(graph, start);
+        ViolationSink sink;
+        FusedVerifier<Graph, PrivChecks>(graph).verify(sink);
+        sink.report(std::cout, format, FusedVerifierDescriber<Graph>(graph));
     }
 
     return 0;
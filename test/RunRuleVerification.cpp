@@ -0,0 +1,94 @@
+// Copyright (c) 2014 Mark S. Dittmer
+//
+// This file is part of Priv2.
+//
+// Priv2 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Priv2 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Priv2.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Platform.h"
+#include "SetuidState.h"
+#include "EdgeTable.h"
+#include "FrozenGraph.h"
+#include "FusedVerifier.h"
+#include "Graph.h"
+#include "GraphReader.h"
+#include "RuleSet.h"
+
+#include <iostream>
+#include <fstream>
+
+typedef SetuidState VP;
+typedef SetuidFunctionCall EP;
+typedef VertexGenerator<UID, SetuidState> VG;
+typedef SetuidEdgeGenerator EG;
+
+typedef SetuidStateGraph<VP, EP, VG, EG> SourceGraph;
+typedef FrozenSetuidStateGraph<EP, VG, EG> Graph;
+
+// Checks archives against rules read from a file (see RuleSet.h for the rule
+// language), e.g. a file containing:
+//   setuid() success sets euid: function == setuid && return == 0 -> post.euid == param1
+//   calls only fail with -1: return == 0 || return == -1
+int main(int argc, char* argv[]) {
+    std::vector<std::string> names;
+
+    // Violations are reported on stdout as CSV, or as JSON given "--json"
+    ViolationSink::Format format = ViolationSink::CSV;
+    int argi = 1;
+    if (argi < argc && std::string(argv[argi]) == "--json") {
+        format = ViolationSink::JSON;
+        ++argi;
+    }
+
+    if (argc - argi < 2) {
+        std::cerr << "ERROR: Must have at least two arguments: rules-file "
+                  << "archive-file-basename" << std::endl;
+        return -1;
+    }
+
+    std::string const rulesFile = argv[argi++];
+    std::ifstream is(rulesFile.c_str());
+    if (!is) {
+        std::cerr << "ERROR: Cannot read rules from \"" << rulesFile << "\""
+                  << std::endl;
+        return -1;
+    }
+    RuleSet rules;
+    std::string error;
+    if (!rules.parse(is, error)) {
+        std::cerr << "ERROR: " << rulesFile << ": " << error << std::endl;
+        return -1;
+    }
+
+    for (int i = argi; i < argc; ++i) {
+        names.push_back(argv[i]);
+    }
+
+    ArchiveReader<SourceGraph> reader;
+    for (std::vector<std::string>::const_iterator it = names.begin(),
+             ie = names.end(); it != ie; ++it) {
+        Graph const graph = freeze(reader.read(*it));
+        EdgeTable const table(graph);
+
+        std::cerr << std::endl << " :: Checking " << rules.size()
+                  << " rules against " << table.size() << " edges of \""
+                  << *it << "\"" << std::endl;
+
+        ViolationSink sink;
+        rules.check(table, sink);
+        sink.report(std::cout, format, FusedVerifierDescriber<Graph>(graph));
+    }
+
+    return 0;
+}